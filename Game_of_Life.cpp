@@ -7,16 +7,83 @@
  * @date March, 2020
  */
 
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <random>
 #include <string>
+#include <utility>
 
 // Uses cxxopts from https://github.com/jarro2783/cxxopts under the MIT license
 #include "cxxopts/cxxopts.hxx"
 
 #include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+#include "topology.h"
 #include "world.h"
 #include "zoo.h"
 
+/**
+ * Cross-check every step kernel supported by this CPU against the per cell reference kernel,
+ * by stepping the same random grids with each and comparing the results.
+ * Sizes are chosen to straddle word and vector boundaries, and every topology is tested.
+ *
+ * @param rule
+ *      The rule to step the grids with.
+ *
+ * @return
+ *      True if every kernel matched the reference on every grid.
+ */
+bool verify_kernels(const Rule &rule) {
+    const Kernel::Type types[] = {Kernel::Type::SCALAR, Kernel::Type::LOOKUP, Kernel::Type::SSE2, Kernel::Type::AVX2,
+                                  Kernel::Type::AVX512};
+    std::mt19937 random(371);
+    bool passed = true;
+
+    for (const Kernel::Type type : types) {
+        if (!Kernel::is_supported(type)) {
+            std::cout << Kernel::get_name(type) << ": not supported, skipped" << std::endl;
+            continue;
+        }
+
+        unsigned int failures = 0;
+        for (int trial = 0; trial < 200; trial++) {
+            // Random size up to 9 words wide, and a random density of alive cells
+            const unsigned int width  = 1 + random() % 576;
+            const unsigned int height = 1 + random() % 24;
+            const unsigned int density = 2 + random() % 6;
+            Grid grid(width, height);
+            for (unsigned int y = 0; y < height; y++) {
+                for (unsigned int x = 0; x < width; x++) {
+                    if (random() % density == 0) {
+                        grid.set(x, y, Cell::ALIVE);
+                    }
+                }
+            }
+
+            for (const Topology::Type topology : {Topology::Type::DEAD, Topology::Type::TORUS,
+                                                  Topology::Type::CYLINDER, Topology::Type::REFLECT}) {
+                World reference(grid), world(grid);
+                reference.set_kernel(Kernel::Type::REFERENCE);
+                reference.set_rule(rule);
+                world.set_kernel(type);
+                world.set_rule(rule);
+                reference.advance(4, topology);
+                world.advance(4, topology);
+                if (reference.get_state() != world.get_state()) {
+                    failures++;
+                }
+            }
+        }
+
+        std::cout << Kernel::get_name(type) << ": " << (failures == 0 ? "passed" : "FAILED")
+                  << " (" << failures << " mismatches)" << std::endl;
+        passed = passed && (failures == 0);
+    }
+    return passed;
+}
+
 int main(int argc, char *argv[]) {
 
     cxxopts::Options options("Game_of_Life",
@@ -29,6 +96,16 @@ int main(int argc, char *argv[]) {
             ("s,steps","The number of steps to simulate the world.", cxxopts::value<int>()->default_value("10"))
             ("e,every","Print world to the console every N steps. 0 disables printing.", cxxopts::value<int>()->default_value("0"))
             ("t,toroidal", "Simulate the Game of Life on a torus.", cxxopts::value<bool>()->default_value("false"))
+            ("topology", "The edges of the world: dead, torus, cylinder or reflect. Overrides --toroidal.", cxxopts::value<std::string>())
+            ("j,threads", "The number of threads to step the world with.", cxxopts::value<int>()->default_value("1"))
+            ("b,block", "Generations to step each block of rows per pass over memory, 1 steps one generation at a time.", cxxopts::value<int>()->default_value("8"))
+            ("hashlife", "Advance the world with the HashLife engine on an unbounded plane, implies --unbounded.")
+            ("sparse", "Advance the world with the sparse engine, stepping only the 64x64 chunks with alive cells.")
+            ("event", "Advance the world with the event driven engine, only looking at cells next to the cells that changed.")
+            ("r,rule", "The Life-like rule to simulate in B/S notation, such as B36/S23 for HighLife.", cxxopts::value<std::string>()->default_value("B3/S23"))
+            ("u,unbounded", "Grow the world to follow its alive cells across an unbounded plane, when its edges are dead.")
+            ("m,mapped", "Step the world in a memory mapped file at the provided path, resuming it if the file exists.", cxxopts::value<std::string>())
+            ("verify", "Cross-check every supported step kernel against the reference on random grids, then exit.")
             ("h,help", "Print usage.");
 
     // Actually parse the command line arguments
@@ -40,10 +117,49 @@ int main(int argc, char *argv[]) {
         std::exit(0);
     }
 
+    // Parse the rule, which every kernel and engine is specialized for
+    Rule rule;
+    try {
+        rule = Rule(result["rule"].as<std::string>());
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
+
+    // Run the kernel self test instead of a simulation
+    if (result.count("verify")) {
+        std::exit(verify_kernels(rule) ? 0 : -1);
+    }
+
     // Parse the (potentially defaulted) parameters for this simulation
     const int  steps    = result["steps"].as<int>();
     const int  every    = result["every"].as<int>();
     const bool toroidal = result["toroidal"].as<bool>();
+    const int  threads  = result["threads"].as<int>();
+    const int  block    = result["block"].as<int>();
+
+    // Parse the topology, which is dead edges or a torus unless named
+    Topology::Type topology = toroidal ? Topology::Type::TORUS : Topology::Type::DEAD;
+    if (result.count("topology")) {
+        try {
+            topology = Topology::from_name(result["topology"].as<std::string>());
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    }
+
+    if (threads < 1) {
+        std::cerr << "--threads must be at least 1." << std::endl;
+        std::exit(-1);
+    }
+
+    if (block < 1) {
+        std::cerr << "--block must be at least 1." << std::endl;
+        std::exit(-1);
+    }
 
     // Start with an empty grid
     Grid grid;
@@ -60,16 +176,48 @@ int main(int argc, char *argv[]) {
     }
 
     // Construct a world from the parsed grid
-    World world(grid);
+    World world(std::move(grid));
+    world.set_threads(threads);
+    world.set_block_depth(block);
+    world.set_rule(rule);
+    if (result.count("hashlife")) {
+        world.set_engine(World::Engine::HASHLIFE);
+    }
+    if (result.count("sparse")) {
+        world.set_engine(World::Engine::SPARSE);
+    }
+    if (result.count("event")) {
+        world.set_engine(World::Engine::EVENT);
+    }
+    world.set_unbounded(result.count("unbounded") > 0 || result.count("hashlife") > 0);
+
+    // Move the world into a mapped file, or carry on from the world already in it
+    if (result.count("mapped")) {
+        const std::string path = result["mapped"].as<std::string>();
+        try {
+            if (std::ifstream(path).good()) {
+                world.open_mapped(path);
+            } else {
+                world.create_mapped(path);
+            }
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    }
 
     // Print the initial state of the grid
     std::cout << "Initial state..." << std::endl
               << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
               << world.get_state() << std::endl;
 
-    // Perform the requested number of update steps
-    for (int step = 0; step < steps; step++) {
-        world.step(toroidal);
+    // Perform the requested number of update steps, all at once if no printing is needed along the way
+    if (every <= 0) {
+        world.advance(steps, topology);
+    }
+    for (int step = 0; every > 0 && step < steps; step++) {
+        world.step(topology);
 
         // Print the state of the grid every N steps
         if ((every > 0) && (step % every == 0)) {
@@ -83,6 +231,19 @@ int main(int argc, char *argv[]) {
               << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
               << world.get_state() << std::endl;
 
+    // Report where the world has moved to on the plane
+    if (world.is_unbounded()) {
+        std::int64_t x0, y0;
+        world.get_state(x0, y0);
+        std::cout << "Origin " << x0 << "," << y0 << std::endl;
+    }
+
+    // Report if the world settled into a still life or a cycle along the way
+    if (world.get_period() != 0) {
+        std::cout << "Cycle of period " << world.get_period()
+                  << " from generation " << world.get_cycle_start() << std::endl;
+    }
+
     // Attempt to save to the output directory if a path was given
     if (result.count("output")) {
         try {
@@ -0,0 +1,144 @@
+/**
+* Checks that stepping or advancing a world and printing its state allocate no memory once the world is set up.
+* Every call to operator new in the program is counted, so the count across the steps and the printing
+* of each world below must stay the same. Worlds larger than World::BLOCK_BYTES are also advanced, which
+* takes them through temporal blocking.
+*
+* @author 951939
+* @date March, 2020
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <streambuf>
+
+#include "grid.h"
+#include "kernel.h"
+#include "world.h"
+
+// The number of calls to operator new so far, from any thread of a pool
+static std::atomic<unsigned long> allocations(0);
+
+void *operator new(std::size_t size) {
+    allocations++;
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    allocations++;
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    if (void *memory = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+// A stream buffer that throws away everything written to it
+class DiscardBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override {
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char *, std::streamsize count) override {
+            return count;
+        }
+};
+
+// Step and print a world, returning the number of allocations made after a first warm up step
+static unsigned long count_allocations(World &world, const bool toroidal, std::ostream &discard) {
+    world.step(toroidal);
+    discard << world.get_state();
+    const unsigned long before = allocations;
+    for (int i = 0; i < 64; i++) {
+        world.step(toroidal);
+        discard << world.get_state();
+    }
+    return allocations - before;
+}
+
+// Advance and print a world, returning the number of allocations made after a first warm up advance
+static unsigned long count_advance_allocations(World &world, const bool toroidal, std::ostream &discard) {
+    world.advance(16, toroidal);
+    discard << world.get_state();
+    const unsigned long before = allocations;
+    for (int i = 0; i < 4; i++) {
+        world.advance(16, toroidal);
+        discard << world.get_state();
+    }
+    return allocations - before;
+}
+
+// Fill a grid with a random soup, which keeps changing for far longer than the steps below
+static Grid make_soup(const unsigned int width, const unsigned int height) {
+    std::mt19937 random(371);
+    Grid soup(width, height);
+    for (unsigned int y = 0; y < soup.get_height(); y++) {
+        for (unsigned int x = 0; x < soup.get_width(); x++) {
+            soup(x, y) = (random() % 3 == 0) ? Cell::ALIVE : Cell::DEAD;
+        }
+    }
+    return soup;
+}
+
+int main() {
+
+    // A soup small enough to be stepped a generation at a time, and one large enough to be advanced in blocks
+    const Grid soup = make_soup(300, 200);
+    const Grid large_soup = make_soup(2048, 2048);
+
+    DiscardBuffer buffer;
+    std::ostream discard(&buffer);
+
+    // Try each kernel with one thread and with a pool of threads, with dead and wrapping edges
+    bool failed = false;
+    for (const Kernel::Type kernel : {Kernel::best(), Kernel::Type::SCALAR, Kernel::Type::LOOKUP}) {
+        for (const unsigned int threads : {1U, 4U}) {
+            for (const bool toroidal : {false, true}) {
+                World world(soup);
+                world.set_kernel(kernel);
+                world.set_threads(threads);
+                const unsigned long count = count_allocations(world, toroidal, discard);
+                std::cout << "kernel " << Kernel::get_name(kernel) << ", " << threads << " threads, "
+                          << (toroidal ? "torus" : "dead edges") << ": " << count << " allocations" << std::endl;
+                failed = failed || count != 0;
+            }
+        }
+    }
+
+    // Advance the large soup in blocks with one thread and with a pool of threads, with dead and wrapping edges
+    for (const unsigned int threads : {1U, 4U}) {
+        for (const bool toroidal : {false, true}) {
+            World world(large_soup);
+            world.set_threads(threads);
+            const unsigned long count = count_advance_allocations(world, toroidal, discard);
+            std::cout << "advance, " << threads << " threads, " << (toroidal ? "torus" : "dead edges") << ": "
+                      << count << " allocations" << std::endl;
+            failed = failed || count != 0;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "grid.h"
+#include "grid_view.h"
 #include "world.h"
 #include "zoo.h"
 
@@ -14,10 +15,11 @@ int main(int argc, char *argv[]) {
     // Start with an empty grid
     Grid grid(32, 10);
 
-    Grid glider    = Zoo::glider(),
-         glider90  = glider.rotate(1),
-         glider180 = glider.rotate(2),
-         glider270 = glider.rotate(3);
+    // View the glider rotated in place rather than making a rotated copy of each
+    const Grid glider = Zoo::glider();
+    const GridView glider90  = GridView(glider).rotate(1),
+                   glider180 = GridView(glider).rotate(2),
+                   glider270 = GridView(glider).rotate(3);
 
     // Place gliders in the 4 corners all flying towards the centre
     grid.merge(glider, 1, 1, true);
@@ -0,0 +1,597 @@
+/**
+ * Implements a class representing a 2d grid of cells that keeps the number of alive neighbours of every cell.
+ *      - New cells are initialized to Cell::DEAD.
+ *      - Event grids can be made from a Grid and exported back to a Grid.
+ *      - Event grids can return counts of the alive and dead cells, and the bounding box of the alive cells,
+ *        in O(1) time.
+ *      - Event grids can step themselves forward one generation of Conway's Game of Life, or another
+ *        Life-like rule set by EventGrid::set_rule.
+ *
+ *      - Each cell is one byte. Bit 0 is set if the cell is alive, bits 1 to 4 hold the number of its
+ *        neighbours that are alive, and bit 5 marks a cell already queued to be looked at by a step.
+ *          - The counts are found once, on the first step, and after that are only changed by births and
+ *            deaths, which add or take 1 from the count of each of the 8 neighbours of the cell.
+ *          - The counts depend on the topology, so they are found again if a step changes it.
+ *          - A byte per cell is 8 times the memory of a Grid, which is the price of never recounting.
+ *
+ *      - EventGrid::step only looks at the cells that changed in the last generation and their neighbours.
+ *          - A cell can only change if it or one of its neighbours changed in the last generation,
+ *            otherwise its state and count are the same as when it last stayed the same.
+ *          - The cells that flip are found first and only then flipped, so every decision is made on the
+ *            counts of the old generation. The cells that flipped are the changes the next step looks at.
+ *          - So the cost of a step follows the number of births and deaths, not the area of the grid.
+ *            Every cell is looked at on the first step, as the changes before it are not known.
+ *          - The cells that flipped can be read back with EventGrid::get_changed, so a copy of the grid
+ *            elsewhere can be kept in step by flipping the same cells.
+ *
+ *      - The number of alive cells in each row and each column is kept as cells flip.
+ *          - The bounding box grows at once around a birth, and after a step its edges move in past
+ *            any rows and columns that have emptied, so it is always the smallest box.
+ *          - Edges only move in as far as they moved out, so keeping the box costs no more than the flips.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "event_grid.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include "grid.h"
+#include "rule.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//the bits of the byte of each cell
+static const unsigned char CELL_ALIVE = 0x01;
+static const unsigned char COUNT_ONE = 0x02;
+static const unsigned char COUNT_MASK = 0x1E;
+static const unsigned char CELL_QUEUED = 0x20;
+
+/**
+ * EventGrid::EventGrid()
+ *
+ * Construct an empty event grid of size 0x0.
+ */
+
+EventGrid::EventGrid(): EventGrid(0) {
+}
+
+/**
+ * EventGrid::EventGrid(square_size)
+ *
+ * Construct a square event grid with the desired size filled with dead cells.
+ *
+ * @param square_size
+ *      The edge size to use for the width and height of the grid.
+ */
+
+EventGrid::EventGrid(const unsigned int square_size): EventGrid(square_size,square_size) {
+}
+
+/**
+ * EventGrid::EventGrid(width, height)
+ *
+ * Construct an event grid with the desired size filled with dead cells.
+ *
+ * @example
+ *
+ *      // Make a 1000x1000 grid and place a blinker in the middle
+ *      EventGrid grid(1000);
+ *      grid.set(499, 500, Cell::ALIVE);
+ *      grid.set(500, 500, Cell::ALIVE);
+ *      grid.set(501, 500, Cell::ALIVE);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ */
+
+EventGrid::EventGrid(const unsigned int width, const unsigned int height):
+    width(width), height(height), cells((std::size_t) width*height, 0), row_cells(height, 0), column_cells(width, 0),
+    bounds_x0(0), bounds_y0(0), bounds_x1(0), bounds_y1(0), alive_cells(0), counted(false), counted_toroidal(false) {
+}
+
+/**
+ * EventGrid::EventGrid(grid)
+ *
+ * Construct an event grid holding the same cells as a Grid.
+ *
+ * @param grid
+ *      The grid to copy the cells from.
+ */
+
+EventGrid::EventGrid(const Grid &grid): EventGrid(grid.get_width(), grid.get_height()) {
+    //only the set bits of each word of the grid need writing
+    for (unsigned int y = 0; y < height; y++) {
+        const std::uint64_t *row = grid.get_row_unchecked(y);
+        for (unsigned int i = 0; i < grid.get_words_per_row(); i++) {
+            std::uint64_t word = row[i];
+            while (word!=0) {
+                const std::size_t index = (std::size_t) y*width+i*64+__builtin_ctzll(word);
+                cells[index] = CELL_ALIVE;
+                count_cell(index, true);
+                word &= word-1;
+            }
+        }
+    }
+    alive_cells = grid.get_alive_cells();
+}
+
+/**
+ * EventGrid::get_width()
+ *
+ * Gets the current width of the grid.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The width of the grid.
+ */
+
+unsigned int EventGrid::get_width() const {
+    return width;
+}
+
+/**
+ * EventGrid::get_height()
+ *
+ * Gets the current height of the grid.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The height of the grid.
+ */
+
+unsigned int EventGrid::get_height() const {
+    return height;
+}
+
+/**
+ * EventGrid::get_total_cells()
+ *
+ * Gets the total number of cells in the grid, which may not fit in an unsigned int.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of total cells.
+ */
+
+std::uint64_t EventGrid::get_total_cells() const {
+    return std::uint64_t(width)*height;
+}
+
+/**
+ * EventGrid::get_alive_cells()
+ *
+ * Counts how many cells in the grid are alive, tracked as cells are written and stepped.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+
+std::uint64_t EventGrid::get_alive_cells() const {
+    return alive_cells;
+}
+
+/**
+ * EventGrid::get_dead_cells()
+ *
+ * Counts how many cells in the grid are dead.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+
+std::uint64_t EventGrid::get_dead_cells() const {
+    return get_total_cells()-get_alive_cells();
+}
+
+/**
+ * EventGrid::get_num_changed()
+ *
+ * Gets the number of cells that were born or died in the last step, which is how many cells the
+ * next step starts from.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of cells that changed.
+ */
+
+std::size_t EventGrid::get_num_changed() const {
+    return changed.size();
+}
+
+/**
+ * EventGrid::get_changed()
+ *
+ * Gets the cells that were born or died in the last step, as the index y*width+x of each cell.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Keep a grid in step with an event grid, flipping only the cells that changed
+ *      grid.step();
+ *      for (const std::size_t index : event_grid.get_changed()) {
+ *          ...
+ *      }
+ *
+ * @return
+ *      A reference to the indexes of the cells that changed, valid until the next step.
+ */
+
+const std::vector<std::size_t> &EventGrid::get_changed() const {
+    return changed;
+}
+
+/**
+ * EventGrid::get_bounds(x0, y0, x1, y1)
+ *
+ * Gets the smallest rectangle holding every alive cell, which is kept up to date as cells flip.
+ * The function should be callable from a constant context.
+ *
+ * @param x0
+ *      Set to the x coordinate of the left edge of the box (inclusive).
+ *
+ * @param y0
+ *      Set to the y coordinate of the top edge of the box (inclusive).
+ *
+ * @param x1
+ *      Set to the x coordinate of the right edge of the box (exclusive).
+ *
+ * @param y1
+ *      Set to the y coordinate of the bottom edge of the box (exclusive).
+ *
+ * @return
+ *      True if any cell is alive, false if the grid is empty and the box was not set.
+ */
+
+bool EventGrid::get_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const {
+    if (alive_cells==0) {
+        return false;
+    }
+    x0 = bounds_x0;
+    y0 = bounds_y0;
+    x1 = bounds_x1;
+    y1 = bounds_y1;
+    return true;
+}
+
+/**
+ * EventGrid::get_rule()
+ *
+ * Gets the rule the grid is stepped with.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The rule in use, Rule::conway() unless changed by EventGrid::set_rule.
+ */
+
+const Rule &EventGrid::get_rule() const {
+    return rule;
+}
+
+/**
+ * EventGrid::set_rule(rule)
+ *
+ * Sets the Life-like rule the grid is stepped with.
+ * Cells that were still under the old rule may not be under the new one, so the next step looks at
+ * every cell again.
+ *
+ * @example
+ *
+ *      // Make a grid following Day & Night
+ *      EventGrid grid(1000);
+ *      grid.set_rule(Rule::day_and_night());
+ *
+ * @param rule
+ *      The rule to use.
+ */
+
+void EventGrid::set_rule(const Rule &rule) {
+    this->rule = rule;
+    counted = false;
+}
+
+/**
+ * EventGrid::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate.
+ * The function should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+
+Cell EventGrid::get(const int x, const int y) const {
+    if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
+        return (cells[(std::size_t) y*width+x] & CELL_ALIVE) ? Cell::ALIVE : Cell::DEAD;
+    } else {
+        throw std::out_of_range("EventGrid::get out of bounds.");
+    }
+}
+
+/**
+ * EventGrid::set(x, y, value)
+ *
+ * Overwrites the value at the desired coordinate.
+ * Once the counts have been found, a cell that changes updates the counts of its neighbours and is
+ * looked at by the next step, as if it had changed in a step.
+ *
+ * @param x
+ *      The x coordinate of the cell to update.
+ *
+ * @param y
+ *      The y coordinate of the cell to update.
+ *
+ * @param value
+ *      The value to be written to the selected cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+
+void EventGrid::set(const int x, const int y, const Cell value) {
+    if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
+        const std::size_t index = (std::size_t) y*width+x;
+        if (((cells[index] & CELL_ALIVE)!=0)==(value==Cell::ALIVE)) {
+            return;
+        }
+        if (counted) {
+            flip(index);
+            changed.push_back(index);
+        } else {
+            cells[index] ^= CELL_ALIVE;
+            alive_cells += (value==Cell::ALIVE) ? 1 : -1;
+            count_cell(index, value==Cell::ALIVE);
+        }
+        shrink_bounds();
+    } else {
+        throw std::out_of_range("EventGrid::set out of bounds.");
+    }
+}
+
+/**
+ * EventGrid::get_neighbours(index, neighbours)
+ *
+ * Private helper function to find the indexes of the neighbours of a cell, wrapping around the edges if
+ * the counts are for a torus and leaving out cells beyond the edges otherwise. On a torus 2 cells across
+ * the same neighbour is listed once for each side it borders, and a cell is never its own neighbour,
+ * as in World::count_neighbours.
+ *
+ * @return
+ *      The number of neighbours written, at most 8.
+ */
+
+unsigned int EventGrid::get_neighbours(const std::size_t index, std::size_t neighbours[8]) const {
+    const unsigned int x = index%width, y = index/width;
+    //cells away from the edges have all 8 neighbours at fixed offsets
+    if (x>0 && x+1<width && y>0 && y+1<height) {
+        neighbours[0] = index-width-1;
+        neighbours[1] = index-width;
+        neighbours[2] = index-width+1;
+        neighbours[3] = index-1;
+        neighbours[4] = index+1;
+        neighbours[5] = index+width-1;
+        neighbours[6] = index+width;
+        neighbours[7] = index+width+1;
+        return 8;
+    }
+    unsigned int num_neighbours = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            std::int64_t nx = (std::int64_t) x+dx, ny = (std::int64_t) y+dy;
+            if (nx<0 || nx>=width || ny<0 || ny>=height) {
+                if (!counted_toroidal) {
+                    continue;
+                }
+                nx = (nx+width)%width;
+                ny = (ny+height)%height;
+            }
+            const std::size_t neighbour = (std::size_t) ny*width+nx;
+            if (neighbour!=index) {
+                neighbours[num_neighbours++] = neighbour;
+            }
+        }
+    }
+    return num_neighbours;
+}
+
+/**
+ * EventGrid::flip(index)
+ *
+ * Private helper function to bring a dead cell to life or kill an alive one, and update the counts
+ * of its neighbours.
+ */
+
+void EventGrid::flip(const std::size_t index) {
+    cells[index] ^= CELL_ALIVE;
+    const bool born = (cells[index] & CELL_ALIVE)!=0;
+    alive_cells += born ? 1 : -1;
+    count_cell(index, born);
+    std::size_t neighbours[8];
+    const unsigned int num_neighbours = get_neighbours(index, neighbours);
+    for (unsigned int i = 0; i < num_neighbours; i++) {
+        if (born) {
+            cells[neighbours[i]] += COUNT_ONE;
+        } else {
+            cells[neighbours[i]] -= COUNT_ONE;
+        }
+    }
+}
+
+/**
+ * EventGrid::count_cell(index, born)
+ *
+ * Private helper function to count a cell that was born or died in the alive cells of its row and column,
+ * and grow the bounding box to take in a birth. The box is only shrunk by EventGrid::shrink_bounds.
+ */
+
+void EventGrid::count_cell(const std::size_t index, const bool born) {
+    const unsigned int x = index%width, y = index/width;
+    if (!born) {
+        row_cells[y]--;
+        column_cells[x]--;
+        return;
+    }
+    row_cells[y]++;
+    column_cells[x]++;
+    if (bounds_x0==bounds_x1) {
+        bounds_x0 = x;
+        bounds_y0 = y;
+        bounds_x1 = x+1;
+        bounds_y1 = y+1;
+        return;
+    }
+    bounds_x0 = (x<bounds_x0) ? x : bounds_x0;
+    bounds_y0 = (y<bounds_y0) ? y : bounds_y0;
+    bounds_x1 = (x>=bounds_x1) ? x+1 : bounds_x1;
+    bounds_y1 = (y>=bounds_y1) ? y+1 : bounds_y1;
+}
+
+/**
+ * EventGrid::shrink_bounds()
+ *
+ * Private helper function to move the edges of the bounding box in past any rows and columns left empty
+ * by deaths, so it is again the smallest box holding every alive cell. An empty grid has an empty box.
+ */
+
+void EventGrid::shrink_bounds() {
+    while (bounds_y0<bounds_y1 && row_cells[bounds_y0]==0) {
+        bounds_y0++;
+    }
+    while (bounds_y1>bounds_y0 && row_cells[bounds_y1-1]==0) {
+        bounds_y1--;
+    }
+    while (bounds_x0<bounds_x1 && column_cells[bounds_x0]==0) {
+        bounds_x0++;
+    }
+    while (bounds_x1>bounds_x0 && column_cells[bounds_x1-1]==0) {
+        bounds_x1--;
+    }
+    if (bounds_x0==bounds_x1 || bounds_y0==bounds_y1) {
+        bounds_x0 = bounds_y0 = bounds_x1 = bounds_y1 = 0;
+    }
+}
+
+/**
+ * EventGrid::count_neighbours(new_toroidal)
+ *
+ * Private helper function to find the count of every cell from scratch for a topology, and mark every
+ * alive cell as changed so the next step looks at every cell that could change.
+ *
+ * @param new_toroidal
+ *      If the counts are for a torus.
+ */
+
+void EventGrid::count_neighbours(const bool new_toroidal) {
+    counted = true;
+    counted_toroidal = new_toroidal;
+    changed.clear();
+    for (std::size_t index = 0; index < cells.size(); index++) {
+        cells[index] &= CELL_ALIVE;
+    }
+    std::size_t neighbours[8];
+    for (std::size_t index = 0; index < cells.size(); index++) {
+        if (cells[index] & CELL_ALIVE) {
+            changed.push_back(index);
+            const unsigned int num_neighbours = get_neighbours(index, neighbours);
+            for (unsigned int i = 0; i < num_neighbours; i++) {
+                cells[neighbours[i]] += COUNT_ONE;
+            }
+        }
+    }
+}
+
+/**
+ * EventGrid::step(toroidal)
+ *
+ * Take one step under the rule of the grid, looking only at the cells that changed in the last step
+ * and their neighbours.
+ *
+ * @example
+ *
+ *      // Step a large, quiet world cheaply
+ *      EventGrid grid(Zoo::load_ascii("still_lifes.gol"));
+ *      for (int i = 0; i < 1000; i++) {
+ *          grid.step();
+ *      }
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+
+void EventGrid::step(const bool toroidal) {
+    if (!counted || toroidal!=counted_toroidal) {
+        count_neighbours(toroidal);
+    }
+    //queue each changed cell and its neighbours once
+    candidates.clear();
+    std::size_t neighbours[8];
+    for (const std::size_t index : changed) {
+        if (!(cells[index] & CELL_QUEUED)) {
+            cells[index] |= CELL_QUEUED;
+            candidates.push_back(index);
+        }
+        const unsigned int num_neighbours = get_neighbours(index, neighbours);
+        for (unsigned int i = 0; i < num_neighbours; i++) {
+            if (!(cells[neighbours[i]] & CELL_QUEUED)) {
+                cells[neighbours[i]] |= CELL_QUEUED;
+                candidates.push_back(neighbours[i]);
+            }
+        }
+    }
+    //decide every flip on the old counts before flipping any
+    flips.clear();
+    for (const std::size_t index : candidates) {
+        cells[index] &= ~CELL_QUEUED;
+        const unsigned int count = (cells[index] & COUNT_MASK) >> 1;
+        const Cell cell = (cells[index] & CELL_ALIVE) ? Cell::ALIVE : Cell::DEAD;
+        if (rule.get_next(cell, count)!=cell) {
+            flips.push_back(index);
+        }
+    }
+    for (const std::size_t index : flips) {
+        flip(index);
+    }
+    shrink_bounds();
+    std::swap(changed, flips);
+}
+
+/**
+ * EventGrid::get_grid()
+ *
+ * Exports the cells to a Grid of the same size, reading only the rows and columns of the bounding box.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A grid holding the same cells.
+ */
+
+Grid EventGrid::get_grid() const {
+    Grid grid(width, height);
+    for (unsigned int y = bounds_y0; y < bounds_y1; y++) {
+        std::uint64_t *row = grid.get_row_unchecked(y);
+        const unsigned char *cell = &cells[(std::size_t) y*width];
+        for (unsigned int x = bounds_x0; x < bounds_x1; x++) {
+            row[x/64] |= std::uint64_t(cell[x] & CELL_ALIVE) << (x%64);
+        }
+    }
+    grid.set_alive_cells(alive_cells);
+    return grid;
+}
@@ -0,0 +1,67 @@
+/**
+ * Declares a class representing a 2d grid of cells that keeps the number of alive neighbours of every cell.
+ * Rich documentation for the api and behaviour the EventGrid class can be found in event_grid.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the class.
+// #include ...
+#include "grid.h"
+#include "rule.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+/**
+ * Declare the structure of the EventGrid class for stepping worlds where few cells change each generation.
+ *
+ * Each cell is one byte holding whether it is alive and how many of its neighbours are alive. The counts
+ * are updated as cells are born and die, and only cells next to a change are looked at by a step.
+ */
+class EventGrid {
+    private:
+        unsigned int width;
+        unsigned int height;
+        std::vector<unsigned char> cells;
+        std::vector<std::size_t> changed;
+        std::vector<std::size_t> candidates;
+        std::vector<std::size_t> flips;
+        std::vector<unsigned int> row_cells;
+        std::vector<unsigned int> column_cells;
+        unsigned int bounds_x0;
+        unsigned int bounds_y0;
+        unsigned int bounds_x1;
+        unsigned int bounds_y1;
+        std::uint64_t alive_cells;
+        Rule rule;
+        bool counted;
+        bool counted_toroidal;
+
+        unsigned int get_neighbours(const std::size_t index, std::size_t neighbours[8]) const;
+        void flip(const std::size_t index);
+        void count_cell(const std::size_t index, const bool born);
+        void shrink_bounds();
+        void count_neighbours(const bool new_toroidal);
+    public:
+        EventGrid();
+        explicit EventGrid(const unsigned int square_size);
+        EventGrid(const unsigned int width, const unsigned int height);
+        explicit EventGrid(const Grid &grid);
+
+        unsigned int get_width() const;
+        unsigned int get_height() const;
+        std::uint64_t get_total_cells() const;
+        std::uint64_t get_alive_cells() const;
+        std::uint64_t get_dead_cells() const;
+        std::size_t get_num_changed() const;
+        const std::vector<std::size_t> &get_changed() const;
+        bool get_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const;
+        const Rule &get_rule() const;
+        void set_rule(const Rule &rule);
+        Cell get(const int x, const int y) const;
+        void set(const int x, const int y, const Cell value);
+        void step(const bool toroidal=false);
+        Grid get_grid() const;
+};
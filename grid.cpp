@@ -2,11 +2,48 @@
  * Implements a class representing a 2d grid of cells.
  *      - New cells are initialized to Cell::DEAD.
  *      - Grids can be resized while retaining their contents in the remaining area.
- *      - Grids can be rotated, cropped, and merged together.
- *      - Grids can return counts of the alive and dead cells.
+ *          - Rows are stored a row stride apart with room for a row capacity, which may be more than the
+ *            width and height need, so resizing within that room happens in place without a copy.
+ *            Storage outside the grid is always dead. Grid::reserve makes room ahead of time.
+ *      - Grids can be rotated, transposed, reflected, cropped, and merged together.
+ *          - Rotations are built from a transpose and row and column reflections, all working on whole words.
+ *            The transpose works on 64x64 blocks of cells, each transposed as a bit matrix in registers.
+ *          - A GridView reads a crop, rotation, reflection, or offset of a grid without copying it, and can be
+ *            merged, printed, saved, or used to start a World directly. See grid_view.cpp.
+ *      - Grids can return counts of the alive and dead cells in O(1) time.
+ *          - Counts and cell indices are 64 bit. The width and height each fit in an int, as coordinates
+ *            are ints, but their product may be far beyond 2^32 cells.
+ *          - The number of alive cells is a member kept up to date by every write made through Grid,
+ *            so the counts never need to walk the cells.
+ *          - Code writing whole words through Grid::get_row(y) reports the new count with
+ *            Grid::set_alive_cells(alive_cells), or has it recounted with Grid::recount_alive_cells().
  *      - Grids can be serialized directly to an ascii std::ostream.
  *
- * You are encouraged to use STL container types as an underlying storage mechanism for the grid cells.
+ *      - Cells are stored bit-packed in an std::vector of 64 bit words, one bit per cell.
+ *          - Each row starts on a fresh word, bit (x % 64) of word (x / 64) is the cell in column x.
+ *          - Bits past the width of a row are padding and are always kept at 0, so whole words
+ *            can be counted, copied, and serialized without masking.
+ *          - Word level access is available through Grid::get_row(y) for the step engine and Zoo.
+ *
+ *      - Grids can keep their words in a region of a MappedFile instead of an std::vector.
+ *          - The operating system then pages rows in and out of RAM as they are used, so a grid can be
+ *            larger than RAM, and the cells already in the file are used as they are without loading.
+ *          - Mapped grids always have a halo, so the step engine can use them without a new layout.
+ *          - Copying a mapped grid gives an ordinary grid with a copy of the words. Moving a mapped grid
+ *            moves the mapping. Operations that need a new layout, like Grid::resize, leave the file.
+ *
+ *      - Grids can optionally keep a halo, one extra row of words above and below the cells.
+ *          - Grid::fill_halo(topology) fills the halo with dead cells, with copies of the rows on the
+ *            opposite edge, or with copies of the edge rows themselves, so a stepper can read the rows
+ *            around every row without edge checks.
+ *          - The coordinates, size, and contents of the grid are the same with or without a halo.
+ *            Left and right edges need no halo, as the kernels already carry bits across words in registers.
+ *
+ *      - Internal loops read and write whole rows of words, or use the unchecked accessors.
+ *          - Grid::get_row_unchecked(y), Grid::get_unchecked(x, y), and Grid::set_unchecked(x, y, value)
+ *            skip bounds checks, for callers that have already validated the region they touch.
+ *          - The checked Grid::get, Grid::set, Grid::operator(), and Grid::get_row remain for everyone else,
+ *            and check the bounds exactly once before using the unchecked path.
  *
  * @author 951939
  * @date March, 2020
@@ -15,9 +52,66 @@
 
 // Include the minimal number of headers needed to support your implementation.
 // #include ...
+#include "grid_view.h"
+#include "mapped_file.h"
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * popcount(word)
+ *
+ * Helper to count the number of set bits (alive cells) in a 64 bit word.
+ */
+
+static unsigned int popcount(const std::uint64_t word) {
+    return __builtin_popcountll(word);
+}
+
+/**
+ * read_bits(row, num_words, first_bit)
+ *
+ * Helper to read the 64 cells of a row starting at any column, joining the two words they straddle.
+ * Columns past the end of the row read as 0. The word holding first_bit must be within the row.
+ */
+
+static std::uint64_t read_bits(const std::uint64_t *row, const unsigned int num_words, const unsigned int first_bit) {
+    const unsigned int word = first_bit/Grid::BITS_PER_WORD;
+    const unsigned int shift = first_bit%Grid::BITS_PER_WORD;
+    std::uint64_t bits = row[word] >> shift;
+    if (shift!=0 && word+1<num_words) {
+        bits |= row[word+1] << (Grid::BITS_PER_WORD-shift);
+    }
+    return bits;
+}
+
+/**
+ * transpose_block(block)
+ *
+ * Helper to transpose a 64x64 bit matrix in place, where bit c of block[r] is the cell in row r and
+ * column c. Swaps the off diagonal 32x32 quarters, then the 16x16 quarters within each of those,
+ * and so on down to single bits, 6 rounds of 32 word operations with no bit at a time work.
+ */
+
+static void transpose_block(std::uint64_t block[Grid::BITS_PER_WORD]) {
+    std::uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (unsigned int j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for (unsigned int k = 0; k < Grid::BITS_PER_WORD; k = ((k | j)+1) & ~j) {
+            //the high half of row k swaps with the low half of row k+j
+            const std::uint64_t swap = ((block[k] >> j) ^ block[k | j]) & mask;
+            block[k] ^= swap << j;
+            block[k | j] ^= swap;
+        }
+    }
+}
+
 /**
  * Grid::Grid()
  *
@@ -76,13 +170,266 @@ Grid::Grid(const unsigned int square_size): Grid(square_size,square_size) {
  *
  * @param height
  *      The height of the grid.
+ *
+ * @throws
+ *      std::length_error or sub-class if the width or height does not fit in an int, as with a negative
+ *      size cast to unsigned, or the grid has more words than can be allocated.
+ */
+
+Grid::Grid(const unsigned int width, const unsigned int height):
+    width(width), height(height), words_per_row(width/BITS_PER_WORD+(width%BITS_PER_WORD!=0)),
+    row_stride(words_per_row), row_capacity(height), alive_cells(0), halo_rows(0) {
+    //coordinates are ints, so neither side may be larger than the largest int
+    if (width>INT_MAX || height>INT_MAX) {
+        throw std::length_error("Grid::Grid width/height too large.");
+    }
+    //computed in 64 bits, with room for the halo rows, so the number of words cannot wrap around
+    const std::uint64_t num_words = std::uint64_t(words_per_row)*(std::uint64_t(height)+2);
+    if (num_words>words.max_size()) {
+        throw std::length_error("Grid::Grid too many cells.");
+    }
+    //creates an std::vector of words_per_row*height words full of dead (0) cells
+    words.resize((std::size_t) words_per_row*height,0);
+    data = words.data();
+}
+
+/**
+ * Grid::Grid(mapping, offset, width, height)
+ *
+ * Construct a grid whose words are kept in a region of a memory mapped file, starting offset bytes in.
+ * The region holds a halo row above and below the cells, and Grid::get_mapped_size(width, height) bytes
+ * in total. The cells already in the region are used as they are, nothing is read or cleared, so the
+ * number of alive cells starts at 0 until set with Grid::set_alive_cells or Grid::recount_alive_cells.
+ *
+ * @example
+ *
+ *      // Make a file big enough for a 100000x100000 grid, and a grid over it
+ *      auto file = std::make_shared<MappedFile>("grid.map", Grid::get_mapped_size(100000, 100000));
+ *      Grid grid(file, 0, 100000, 100000);
+ *
+ * @param mapping
+ *      The mapped file holding the words, shared with the grid so it stays mapped while the grid uses it.
+ *
+ * @param offset
+ *      The byte offset of the region in the file, a multiple of 8.
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @throws
+ *      std::exception or sub-class if the region is misaligned or extends past the end of the file,
+ *      or the width or height does not fit in an int.
+ */
+
+Grid::Grid(const std::shared_ptr<MappedFile> &mapping, const std::size_t offset,
+           const unsigned int width, const unsigned int height): Grid(0) {
+    if (width>INT_MAX || height>INT_MAX) {
+        throw std::length_error("Grid::Grid width/height too large.");
+    }
+    const std::size_t size = get_mapped_size(width, height);
+    if (offset%sizeof(std::uint64_t)!=0 || offset>mapping->get_size() || size>mapping->get_size()-offset) {
+        throw std::out_of_range("Grid::Grid mapped region out of range.");
+    }
+    this->width = width;
+    this->height = height;
+    words_per_row = width/BITS_PER_WORD+(width%BITS_PER_WORD!=0);
+    row_stride = words_per_row;
+    row_capacity = height;
+    halo_rows = 1;
+    this->mapping = mapping;
+    data = (size==0) ? nullptr : (std::uint64_t*) ((char*) mapping->get_address()+offset);
+}
+
+/**
+ * Grid::Grid(other)
+ *
+ * Construct a copy of another grid. The copy keeps its words in an std::vector, even if the other
+ * grid is mapped, so changing one never changes the other. As with an std::vector, the copy has no
+ * spare capacity.
+ *
+ * @param other
+ *      The grid to copy.
+ */
+
+Grid::Grid(const Grid &other): Grid(0) {
+    (*this) = other;
+}
+
+/**
+ * Grid::Grid(other)
+ *
+ * Construct a grid by moving the words, or the mapping, out of another grid in O(1) time.
+ * The other grid is left empty, 0x0.
+ *
+ * @param other
+ *      The grid to move from.
+ */
+
+Grid::Grid(Grid &&other) noexcept: width(other.width), height(other.height), words_per_row(other.words_per_row),
+    row_stride(other.row_stride), row_capacity(other.row_capacity), words(std::move(other.words)),
+    mapping(std::move(other.mapping)), data(other.data), alive_cells(other.alive_cells), halo_rows(other.halo_rows) {
+    other.width = other.height = other.words_per_row = other.row_stride = other.row_capacity = other.halo_rows = 0;
+    other.alive_cells = 0;
+    other.words.clear();
+    other.data = other.words.data();
+}
+
+/**
+ * Grid::operator=(other)
+ *
+ * Replaces the grid with a copy of another grid, kept in an std::vector.
+ * The vector is reused when it is already large enough, so copying between grids of the same size
+ * does not allocate.
+ *
+ * @param other
+ *      The grid to copy.
+ *
+ * @return
+ *      The grid itself to enable operator chaining.
+ */
+
+Grid &Grid::operator=(const Grid &other) {
+    if (this!=&other) {
+        //the copy is laid out without spare capacity, and rows are copied one by one as the strides may differ
+        const std::size_t num_words = (std::size_t) other.words_per_row*(other.height+2*other.halo_rows);
+        //the words are copied before any mapping is released, other may share it
+        std::vector<std::uint64_t> new_words;
+        std::vector<std::uint64_t> &target = is_mapped() ? new_words : words;
+        target.assign(num_words, 0);
+        for (int y = -(int) other.halo_rows; y < (int) (other.height+other.halo_rows); y++) {
+            const std::uint64_t *row = other.get_row_unchecked(y);
+            std::uint64_t *new_row = target.data()+(std::size_t) (y+(int) other.halo_rows)*other.words_per_row;
+            for (unsigned int i = 0; i < other.words_per_row; i++) {
+                new_row[i] = row[i];
+            }
+        }
+        if (is_mapped()) {
+            words.swap(new_words);
+            mapping.reset();
+        }
+        data = words.data();
+        width = other.width;
+        height = other.height;
+        words_per_row = other.words_per_row;
+        row_stride = other.words_per_row;
+        row_capacity = other.height;
+        alive_cells = other.alive_cells;
+        halo_rows = other.halo_rows;
+    }
+    return *this;
+}
+
+/**
+ * Grid::operator=(other)
+ *
+ * Replaces the grid by moving the words, or the mapping, out of another grid in O(1) time,
+ * so std::swap of two grids never copies any cells. The other grid is left empty, 0x0.
+ *
+ * @param other
+ *      The grid to move from.
+ *
+ * @return
+ *      The grid itself to enable operator chaining.
+ */
+
+Grid &Grid::operator=(Grid &&other) noexcept {
+    if (this!=&other) {
+        width = other.width;
+        height = other.height;
+        words_per_row = other.words_per_row;
+        row_stride = other.row_stride;
+        row_capacity = other.row_capacity;
+        words = std::move(other.words);
+        mapping = std::move(other.mapping);
+        data = other.data;
+        alive_cells = other.alive_cells;
+        halo_rows = other.halo_rows;
+        other.width = other.height = other.words_per_row = other.row_stride = other.row_capacity = other.halo_rows = 0;
+        other.alive_cells = 0;
+        other.words.clear();
+        other.data = other.words.data();
+    }
+    return *this;
+}
+
+/**
+ * Grid::reverse_bits(word)
+ *
+ * Reverses the order of the 64 bits of a word, so bit 0 becomes bit 63. Reflecting a row of cells
+ * reverses each of its words, here and in the word at a time reads of GridView.
+ *
+ * @param word
+ *      The word to reverse.
+ *
+ * @return
+ *      The word with its bits in the opposite order.
+ */
+
+std::uint64_t Grid::reverse_bits(std::uint64_t word) {
+    word = ((word >> 1) & 0x5555555555555555ULL) | ((word & 0x5555555555555555ULL) << 1);
+    word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+    word = ((word >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((word & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    word = ((word >> 8) & 0x00FF00FF00FF00FFULL) | ((word & 0x00FF00FF00FF00FFULL) << 8);
+    word = ((word >> 16) & 0x0000FFFF0000FFFFULL) | ((word & 0x0000FFFF0000FFFFULL) << 16);
+    return (word >> 32) | (word << 32);
+}
+
+/**
+ * Grid::get_mapped_size(width, height)
+ *
+ * Gets the number of bytes of a mapped file needed to hold a grid of the given size with its halo.
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @return
+ *      The size of the region in bytes.
+ */
+
+std::size_t Grid::get_mapped_size(const unsigned int width, const unsigned int height) {
+    const std::size_t words_per_row = width/BITS_PER_WORD+(width%BITS_PER_WORD!=0);
+    return words_per_row*((std::size_t) height+2)*sizeof(std::uint64_t);
+}
+
+/**
+ * Grid::is_mapped()
+ *
+ * Checks if the words of the grid are kept in a memory mapped file.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      True if the grid is mapped.
  */
 
-Grid::Grid(const unsigned int width, const unsigned int height): width(width), height(height) {
-    //creates an std::vector of cells of size width*height full of dead cells
-    cells.resize(width*height,Cell::DEAD);
+bool Grid::is_mapped() const {
+    return mapping!=nullptr;
 }
 
+/**
+ * Grid::get_num_words()
+ *
+ * Private helper function to get the number of words stored, including any halo rows and spare capacity.
+ */
+
+std::size_t Grid::get_num_words() const {
+    return (std::size_t) row_stride*(row_capacity+2*halo_rows);
+}
+
+/**
+ * Grid::~Grid()
+ *
+ * Grids own no resources beyond their std::vector of words, and a share of their mapped file if any,
+ * which is unmapped once no grid uses it.
+ * Copy and move construction and assignment are declared alongside the destructor, as declaring it
+ * would otherwise suppress the move operations, turning every std::swap of two grids into three full copies.
+ */
+
 Grid::~Grid() {
 }
 
@@ -166,14 +513,15 @@ unsigned int Grid::get_height() const {
  *      The number of total cells.
  */
 
-unsigned int Grid::get_total_cells() const {
-    return cells.size();
+std::uint64_t Grid::get_total_cells() const {
+    return std::uint64_t(width)*height;
 }
 
 /**
  * Grid::get_alive_cells()
  *
  * Counts how many cells in the grid are alive.
+ * The count is tracked as cells are written, so this takes O(1) time.
  * The function should be callable from a constant context.
  *
  * @example
@@ -194,14 +542,15 @@ unsigned int Grid::get_total_cells() const {
  *      The number of alive cells.
  */
 
-unsigned int Grid::get_alive_cells() const{
-    return get_total_cells()-get_dead_cells();
+std::uint64_t Grid::get_alive_cells() const{
+    return alive_cells;
 }
 
 /**
  * Grid::get_dead_cells()
  *
  * Counts how many cells in the grid are dead.
+ * Derived from the tracked number of alive cells, so this takes O(1) time.
  * The function should be callable from a constant context.
  *
  * @example
@@ -222,17 +571,51 @@ unsigned int Grid::get_alive_cells() const{
  *      The number of dead cells.
  */
 
-unsigned int Grid::get_dead_cells() const{
-    //From idx to x,y, iterates through std::vector of cells to calculate number of dead cells
-    unsigned int x, y, dead_cells = 0;
-    for (unsigned int idx=0; idx<get_total_cells(); idx++) {
-        x = idx % get_width();
-        y = (idx - x) / get_width();
-        if (get(x,y)==Cell::DEAD) {
-            dead_cells++;
+std::uint64_t Grid::get_dead_cells() const{
+    //every cell that is not alive is dead
+    return get_total_cells()-get_alive_cells();
+}
+
+/**
+ * Grid::set_alive_cells(alive_cells)
+ *
+ * Replaces the tracked number of alive cells, for code that writes whole words through Grid::get_row(y)
+ * and has counted the alive cells as it went, such as the step engine.
+ * Reporting a wrong count makes Grid::get_alive_cells() and Grid::get_dead_cells() wrong.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(100, 4);
+ *
+ *      // Set the first 64 cells of row 2 to be alive and report them
+ *      grid.get_row(2)[0] = ~std::uint64_t(0);
+ *      grid.set_alive_cells(64);
+ *
+ * @param alive_cells
+ *      The number of alive cells now in the grid.
+ */
+
+void Grid::set_alive_cells(const std::uint64_t alive_cells) {
+    this->alive_cells = alive_cells;
+}
+
+/**
+ * Grid::recount_alive_cells()
+ *
+ * Recounts the alive cells a word at a time, for code that writes whole words through Grid::get_row(y)
+ * without counting them, such as Zoo::load_binary.
+ */
+
+void Grid::recount_alive_cells() {
+    //padding bits are always 0 so every set bit in the storage is an alive cell
+    alive_cells = 0;
+    for (unsigned int y = 0; y < get_height(); y++) {
+        const std::uint64_t *row = get_row_unchecked(y);
+        for (unsigned int i = 0; i < words_per_row; i++) {
+            alive_cells += popcount(row[i]);
         }
     }
-    return dead_cells;
 }
 
 /**
@@ -264,6 +647,10 @@ void Grid::resize(const unsigned int square_size) {
  * Resize the current grid to a new width and height. The content of the grid
  * should be preserved within the kept region and padded with Grid::DEAD if new cells are added.
  *
+ * Resizing within the capacity of the storage happens in place. Growing only changes the size, and
+ * shrinking only clears the cells cut off. Growing past the capacity moves the cells into storage
+ * half as large again, or just large enough if that is more, as std::vector does.
+ *
  * @example
  *
  *      // Make a grid
@@ -277,25 +664,133 @@ void Grid::resize(const unsigned int square_size) {
  *
  * @param new_height
  *      The new height for the grid.
+ *
+ * @throws
+ *      std::length_error or sub-class if the width or height does not fit in an int.
  */
 
 void Grid::resize(const unsigned int new_width, const unsigned int new_height) {
-    //Create a new grid with updated width/height and loops through x,y
-    Grid new_grid = Grid(new_width, new_height);
-    for (unsigned int y = 0; y < new_height; y++) {
-        for (unsigned int x = 0; x < new_width; x++) {
-            //if within bounds of current grid then 
-            if ((x<get_width()) && (y<get_height())) {
-                //set value of same x,y position onto new grid
-                new_grid.set(x,y,get(x,y));
-            //else pad new area with dead cells
-            } else {
-                new_grid.set(x,y,Cell::DEAD);
+    if (new_width>INT_MAX || new_height>INT_MAX) {
+        throw std::length_error("Grid::resize width/height too large.");
+    }
+    const unsigned int new_words_per_row = new_width/BITS_PER_WORD+(new_width%BITS_PER_WORD!=0);
+    //grow the storage geometrically past the capacity, like an std::vector, so repeated growth is amortized
+    if (is_mapped() || new_words_per_row>row_stride || new_height>row_capacity) {
+        const unsigned int new_row_stride = (new_words_per_row<=row_stride) ? row_stride
+            : (new_words_per_row>row_stride+row_stride/2) ? new_words_per_row : row_stride+row_stride/2;
+        const unsigned int new_row_capacity = (new_height<=row_capacity) ? row_capacity
+            : (new_height>row_capacity+row_capacity/2) ? new_height : row_capacity+row_capacity/2;
+        relayout(new_row_stride, new_row_capacity, halo_rows);
+    }
+    //everything outside the grid is kept dead, so growing needs no writes and shrinking clears what is cut off
+    std::uint64_t removed_cells = 0;
+    const unsigned int kept_height = (new_height<get_height()) ? new_height : get_height();
+    if (new_width<get_width()) {
+        const unsigned int bits = new_width%BITS_PER_WORD;
+        const std::uint64_t mask = (bits==0) ? ~std::uint64_t(0) : ((std::uint64_t(1) << bits)-1);
+        for (unsigned int y = 0; y < kept_height; y++) {
+            std::uint64_t *row = get_row_unchecked(y);
+            for (unsigned int i = new_words_per_row; i < words_per_row; i++) {
+                removed_cells += popcount(row[i]);
+                row[i] = 0;
             }
+            //cells cut off by a narrower width must not be left in the padding
+            if (new_words_per_row>0) {
+                removed_cells += popcount(row[new_words_per_row-1] & ~mask);
+                row[new_words_per_row-1] &= mask;
+            }
+        }
+    }
+    for (unsigned int y = kept_height; y < get_height(); y++) {
+        std::uint64_t *row = get_row_unchecked(y);
+        for (unsigned int i = 0; i < words_per_row; i++) {
+            removed_cells += popcount(row[i]);
+            row[i] = 0;
+        }
+    }
+    //the old halo row below is now a row of the grid or past it, either way it must be dead
+    if (has_halo() && new_height!=get_height()) {
+        std::uint64_t *below = get_row_unchecked(get_height());
+        for (unsigned int i = 0; i < row_stride; i++) {
+            below[i] = 0;
+        }
+    }
+    width = new_width;
+    height = new_height;
+    words_per_row = new_words_per_row;
+    alive_cells -= removed_cells;
+}
+
+/**
+ * Grid::reserve(width, height)
+ *
+ * Makes room for the grid to be resized up to the given width and height without moving its cells,
+ * like std::vector::reserve. The size and contents of the grid do not change.
+ * Reserving less than the grid already has room for does nothing.
+ *
+ * @example
+ *
+ *      // Make a small grid that will grow to 1000x1000 one row at a time
+ *      Grid grid(1000, 1);
+ *      grid.reserve(1000, 1000);
+ *      for (unsigned int h = 2; h <= 1000; h++) {
+ *          grid.resize(1000, h);
+ *      }
+ *
+ * @param new_width
+ *      The width to make room for.
+ *
+ * @param new_height
+ *      The height to make room for.
+ *
+ * @throws
+ *      std::length_error or sub-class if the width or height does not fit in an int.
+ */
+
+void Grid::reserve(const unsigned int new_width, const unsigned int new_height) {
+    if (new_width>INT_MAX || new_height>INT_MAX) {
+        throw std::length_error("Grid::reserve width/height too large.");
+    }
+    const unsigned int new_words_per_row = new_width/BITS_PER_WORD+(new_width%BITS_PER_WORD!=0);
+    if (new_words_per_row>row_stride || new_height>row_capacity) {
+        relayout((new_words_per_row>row_stride) ? new_words_per_row : row_stride,
+                 (new_height>row_capacity) ? new_height : row_capacity, halo_rows);
+    }
+}
+
+/**
+ * Grid::relayout(new_row_stride, new_row_capacity, new_halo_rows)
+ *
+ * Private helper function to move the cells into new storage in memory with the given row stride,
+ * row capacity, and halo, leaving any mapped file. The rest of the new storage is dead.
+ * The new layout must have room for every row and word of the grid.
+ *
+ * @throws
+ *      std::length_error or sub-class if the new storage has more words than can be allocated.
+ */
+
+void Grid::relayout(const unsigned int new_row_stride, const unsigned int new_row_capacity,
+                    const unsigned int new_halo_rows) {
+    //computed in 64 bits so the number of words cannot wrap around
+    const std::uint64_t num_words = std::uint64_t(new_row_stride)*(std::uint64_t(new_row_capacity)+2*new_halo_rows);
+    if (num_words>words.max_size()) {
+        throw std::length_error("Grid::relayout too many cells.");
+    }
+    std::vector<std::uint64_t> new_words((std::size_t) num_words, 0);
+    for (unsigned int y = 0; y < get_height(); y++) {
+        const std::uint64_t *row = get_row_unchecked(y);
+        std::uint64_t *new_row = new_words.data()+(std::size_t) (y+new_halo_rows)*new_row_stride;
+        for (unsigned int i = 0; i < words_per_row; i++) {
+            new_row[i] = row[i];
         }
     }
-    //replace current grid with new grid
-    (*this) = new_grid;
+    //the new layout is always kept in memory, leaving any mapped file
+    words.swap(new_words);
+    data = words.data();
+    mapping.reset();
+    row_stride = new_row_stride;
+    row_capacity = new_row_capacity;
+    halo_rows = new_halo_rows;
 }
 
 /**
@@ -312,12 +807,13 @@ void Grid::resize(const unsigned int new_width, const unsigned int new_height) {
  *      The y coordinate of the cell.
  *
  * @return
- *      The 1d offset from the start of the data array where the desired cell is located.
+ *      The 1d bit offset from the start of the data array where the desired cell is located.
+ *      The word holding the cell is (index / 64) and the bit within that word is (index % 64).
  */
 
-unsigned int Grid::get_index(const unsigned int x, const unsigned int y) const{
-    //from x,y to idx
-    return (x+(y*get_width()));
+std::uint64_t Grid::get_index(const unsigned int x, const unsigned int y) const{
+    //from x,y to idx, rows start on a word boundary after any halo row, in 64 bits as grids may be huge
+    return (x+((std::uint64_t(y)+halo_rows)*row_stride*BITS_PER_WORD));
 }
 
 /**
@@ -326,7 +822,7 @@ unsigned int Grid::get_index(const unsigned int x, const unsigned int y) const{
  * Returns the value of the cell at the desired coordinate.
  * Specifically this function should return a cell value, not a reference to a cell.
  * The function should be callable from a constant context.
- * Should be implemented by invoking Grid::operator()(x, y).
+ * Checks the bounds once, then reads through Grid::get_unchecked(x, y).
  *
  * @example
  *
@@ -350,15 +846,9 @@ unsigned int Grid::get_index(const unsigned int x, const unsigned int y) const{
  */
 
 Cell Grid::get(const int x, const int y) const{
-    //if within bounds then
+    //if within bounds then read the cell, bounds are only checked once
     if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
-        //if cell is alive return alive
-        if (operator()(x,y)==Cell::ALIVE) {
-            return Cell::ALIVE;
-        //else return dead
-        } else {
-            return Cell::DEAD;
-        }
+        return get_unchecked(x,y);
     //else throw exception
     } else {
         throw std::out_of_range("Grid::get out of bounds.");
@@ -369,7 +859,7 @@ Cell Grid::get(const int x, const int y) const{
  * Grid::set(x, y, value)
  *
  * Overwrites the value at the desired coordinate.
- * Should be implemented by invoking Grid::operator()(x, y).
+ * Checks the bounds once, then writes through Grid::set_unchecked(x, y, value).
  *
  * @example
  *
@@ -395,20 +885,96 @@ Cell Grid::get(const int x, const int y) const{
 void Grid::set(const int x, const int y, const Cell value){
     //if within bounds then
     if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
-        //replace value at modifiable reference
-        operator()(x,y) = value;
+        //replace value of the bit
+        set_unchecked(x,y,value);
     //else throw exception
     } else {
         throw std::out_of_range("Grid::set out of bounds.");
     }
 }
 
+/**
+ * Grid::CellReference::CellReference(word, mask)
+ *
+ * Construct a reference to the bit selected by mask within a storage word.
+ * Only Grid hands these out, through Grid::operator()(x, y).
+ *
+ * @param word
+ *      The storage word holding the cell.
+ *
+ * @param mask
+ *      A word with only the bit for the cell set.
+ *
+ * @param alive_cells
+ *      The number of alive cells in the grid, kept up to date by writes through the reference.
+ */
+
+Grid::CellReference::CellReference(std::uint64_t &word, const std::uint64_t mask, std::uint64_t &alive_cells):
+    word(word), mask(mask), alive_cells(alive_cells) {
+}
+
+/**
+ * Grid::CellReference::operator Cell()
+ *
+ * Reads the referenced cell.
+ *
+ * @return
+ *      Cell::ALIVE if the bit is set, Cell::DEAD otherwise.
+ */
+
+Grid::CellReference::operator Cell() const {
+    return (word & mask) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * Grid::CellReference::operator=(value)
+ *
+ * Writes the referenced cell, setting the bit for Cell::ALIVE and clearing it otherwise.
+ * The number of alive cells in the grid changes if the cell does.
+ *
+ * @param value
+ *      The value to be written to the referenced cell.
+ *
+ * @return
+ *      The reference itself to enable operator chaining.
+ */
+
+Grid::CellReference &Grid::CellReference::operator=(const Cell value) {
+    if (value==Cell::ALIVE) {
+        alive_cells += ((word & mask)==0);
+        word |= mask;
+    } else {
+        alive_cells -= ((word & mask)!=0);
+        word &= ~mask;
+    }
+    return *this;
+}
+
+/**
+ * Grid::CellReference::operator=(other)
+ *
+ * Copies the value of another referenced cell into this one, as with grid(0, 0) = grid(1, 1).
+ *
+ * @param other
+ *      The reference to read the value from.
+ *
+ * @return
+ *      The reference itself to enable operator chaining.
+ */
+
+Grid::CellReference &Grid::CellReference::operator=(const CellReference &other) {
+    return (*this) = (Cell) other;
+}
+
 /**
  * Grid::operator()(x, y)
  *
  * Gets a modifiable reference to the value at the desired coordinate.
  * Should be implemented by invoking Grid::get_index(x, y).
  *
+ * As cells are bit-packed the reference is a Grid::CellReference proxy, in the same way as
+ * std::vector<bool>. It converts to a Cell when read and updates the bit when assigned to.
+ *
  * @example
  *
  *      // Make a grid
@@ -422,7 +988,7 @@ void Grid::set(const int x, const int y, const Cell value){
  *
  *      // Extract a reference to an individual cell to avoid calculating it's
  *      // 1d index multiple times if you need to access the cell more than once.
- *      Cell &cell_reference = grid(1, 2);
+ *      Grid::CellReference cell_reference = grid(1, 2);
  *      cell_reference = Cell::DEAD;
  *      cell_reference = Cell::ALIVE;
  *
@@ -439,12 +1005,12 @@ void Grid::set(const int x, const int y, const Cell value){
  *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
  */
 
-Cell &Grid::operator()(const int x, const int y) {
+Grid::CellReference Grid::operator()(const int x, const int y) {
     //if within bounds then
     if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
-        //gets a modifiable reference and returns it
-        Cell &value = (cells[get_index(x, y)]); 
-        return value;
+        //gets a modifiable reference to the bit and returns it
+        const std::uint64_t idx = get_index(x, y);
+        return CellReference(data[idx/BITS_PER_WORD], std::uint64_t(1) << (idx%BITS_PER_WORD), alive_cells);
     //else throw exception
     } else {
         throw std::runtime_error("Grid::operator() out of bounds.");
@@ -454,10 +1020,12 @@ Cell &Grid::operator()(const int x, const int y) {
 /**
  * Grid::operator()(x, y)
  *
- * Gets a read-only reference to the value at the desired coordinate.
+ * Gets the value at the desired coordinate.
  * The operator should be callable from a constant context.
  * Should be implemented by invoking Grid::get_index(x, y).
  *
+ * As cells are bit-packed there is no Cell object to refer to, so the value is returned by copy.
+ *
  * @example
  *
  *      // Make a grid
@@ -476,18 +1044,17 @@ Cell &Grid::operator()(const int x, const int y) {
  *      The y coordinate of the cell to access.
  *
  * @return
- *      A read-only reference to the desired cell.
+ *      The value of the desired cell.
  *
  * @throws
  *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
  */
 
-const Cell &Grid::operator()(const int x, const int y) const {
+Cell Grid::operator()(const int x, const int y) const {
     //if within bounds then
     if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
-        //gets a read-only reference and returns it
-        const Cell &value = cells[get_index(x, y)]; 
-        return value;
+        //reads the bit and returns it as a cell
+        return get_unchecked(x,y);
     //else throw exception
     } else {
         throw std::runtime_error("const Grid::operator() const out of bounds exception.");
@@ -495,31 +1062,289 @@ const Cell &Grid::operator()(const int x, const int y) const {
 }
 
 /**
- * Grid::crop(x0, y0, x1, y1)
+ * Grid::get_words_per_row()
  *
- * Extract a sub-grid from a Grid.
- * The cropped grid spans the range [x0, x1) by [y0, y1) in the original grid.
+ * Gets the number of 64 bit storage words used by each row of the grid.
  * The function should be callable from a constant context.
  *
+ * @return
+ *      The number of words per row, (width + 63) / 64.
+ */
+
+unsigned int Grid::get_words_per_row() const {
+    return words_per_row;
+}
+
+/**
+ * Grid::get_row(y)
+ *
+ * Gets a pointer to the first of the Grid::get_words_per_row() storage words of a row, allowing
+ * the step engine and serializers to read and write 64 cells at a time.
+ * Bit (x % 64) of word (x / 64) is the cell in column x. Callers writing through the pointer
+ * must leave the bits past the width of the row as 0, see Grid::get_row_mask(), and must
+ * report the new number of alive cells, see Grid::set_alive_cells(alive_cells).
+ *
  * @example
  *
  *      // Make a grid
- *      Grid y(4, 4);
- *
- *      // Crop the centre 2x2 in y, trimming a 1 cell border off all sides
- *      Grid x = y.crop(x, 1, 1, 3, 3);
+ *      Grid grid(100, 4);
  *
- * @param x0
- *      Left coordinate of the crop window on x-axis.
+ *      // Set the first 64 cells of row 2 to be alive
+ *      grid.get_row(2)[0] = ~std::uint64_t(0);
+ *      grid.recount_alive_cells();
  *
- * @param y0
- *      Top coordinate of the crop window on y-axis.
+ * @param y
+ *      The y coordinate of the row.
  *
- * @param x1
- *      Right coordinate of the crop window on x-axis (1 greater than the largest index).
+ * @return
+ *      A pointer to the words of the row.
  *
- * @param y1
- *      Bottom coordinate of the crop window on y-axis (1 greater than the largest index).
+ * @throws
+ *      std::exception or sub-class if y is not a valid row within the grid.
+ */
+
+std::uint64_t *Grid::get_row(const int y) {
+    if (y>=0 && y<(int)get_height()) {
+        return get_row_unchecked(y);
+    } else {
+        throw std::out_of_range("Grid::get_row out of bounds.");
+    }
+}
+
+/**
+ * Grid::get_row(y)
+ *
+ * Gets a read-only pointer to the first of the Grid::get_words_per_row() storage words of a row.
+ * The function should be callable from a constant context.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A read-only pointer to the words of the row.
+ *
+ * @throws
+ *      std::exception or sub-class if y is not a valid row within the grid.
+ */
+
+const std::uint64_t *Grid::get_row(const int y) const {
+    if (y>=0 && y<(int)get_height()) {
+        return get_row_unchecked(y);
+    } else {
+        throw std::out_of_range("const Grid::get_row out of bounds.");
+    }
+}
+
+/**
+ * Grid::get_row_mask()
+ *
+ * Gets the mask of the cells that are inside the grid in the last word of each row.
+ * Word level writers AND the last word of a row with this mask to keep the padding bits at 0.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A word with a bit set for every column of the last word that is within the width.
+ */
+
+std::uint64_t Grid::get_row_mask() const {
+    const unsigned int used_bits = width%BITS_PER_WORD;
+    return (used_bits==0) ? ~std::uint64_t(0) : ((std::uint64_t(1) << used_bits)-1);
+}
+
+/**
+ * Grid::get_row_unchecked(y)
+ *
+ * Gets a pointer to the words of a row like Grid::get_row(y), without checking the bounds.
+ * For hot loops that have already validated the rows they touch.
+ * If the grid has a halo, rows -1 and Grid::get_height() are the halo rows above and below the grid.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(100, 4);
+ *
+ *      // Clear every row, y is known to be in bounds
+ *      for (unsigned int y = 0; y < grid.get_height(); y++) {
+ *          std::uint64_t *row = grid.get_row_unchecked(y);
+ *          for (unsigned int i = 0; i < grid.get_words_per_row(); i++) {
+ *              row[i] = 0;
+ *          }
+ *      }
+ *      grid.set_alive_cells(0);
+ *
+ * @param y
+ *      The y coordinate of the row, which must be less than the height. Not checked.
+ *
+ * @return
+ *      A pointer to the words of the row.
+ */
+
+std::uint64_t *Grid::get_row_unchecked(const int y) {
+    return data+(std::ptrdiff_t) (y+(int) halo_rows)*row_stride;
+}
+
+/**
+ * Grid::get_row_unchecked(y)
+ *
+ * Gets a read-only pointer to the words of a row like Grid::get_row(y), without checking the bounds.
+ * If the grid has a halo, rows -1 and Grid::get_height() are the halo rows above and below the grid.
+ * The function should be callable from a constant context.
+ *
+ * @param y
+ *      The y coordinate of the row, which must be less than the height. Not checked.
+ *
+ * @return
+ *      A read-only pointer to the words of the row.
+ */
+
+const std::uint64_t *Grid::get_row_unchecked(const int y) const {
+    return data+(std::ptrdiff_t) (y+(int) halo_rows)*row_stride;
+}
+
+/**
+ * Grid::has_halo()
+ *
+ * Checks if the grid keeps a halo row above and below its cells.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      True if the grid has a halo.
+ */
+
+bool Grid::has_halo() const {
+    return halo_rows!=0;
+}
+
+/**
+ * Grid::set_halo(halo)
+ *
+ * Adds or removes the halo rows above and below the cells, moving the cells into the new layout.
+ * The coordinates and contents of the grid do not change. Does nothing if the grid already has the layout.
+ * Removing the halo of a mapped grid moves its cells out of the file into memory.
+ *
+ * @example
+ *
+ *      // Make a grid and give it a halo
+ *      Grid grid(100, 4);
+ *      grid.set_halo(true);
+ *
+ *      // Fill the halo with the opposite edges, row -1 is now a copy of row 3
+ *      grid.fill_halo(Topology::Type::TORUS);
+ *      const std::uint64_t *above = grid.get_row_unchecked(-1);
+ *
+ * @param halo
+ *      True to add the halo, false to remove it.
+ */
+
+void Grid::set_halo(const bool halo) {
+    if (halo==has_halo()) {
+        return;
+    }
+    relayout(row_stride, row_capacity, halo ? 1 : 0);
+}
+
+/**
+ * Grid::fill_halo(topology)
+ *
+ * Fills the halo rows for a step, so the rows above and below every row of the grid can be read directly.
+ *
+ * @param topology
+ *      If the top and bottom edges wrap, the halo above is a copy of the bottom row and the halo below a copy
+ *      of the top row. If the edges reflect, the halo above is a copy of the top row and the halo below a copy
+ *      of the bottom row. Otherwise both are filled with dead cells.
+ *
+ * @throws
+ *      std::logic_error or sub-class if the grid does not have a halo.
+ */
+
+void Grid::fill_halo(const Topology::Type topology) {
+    if (!has_halo()) {
+        throw std::logic_error("Grid::fill_halo grid has no halo.");
+    }
+    const int rows = get_height();
+    std::uint64_t *above = get_row_unchecked(-1), *below = get_row_unchecked(rows);
+    //the rows copied into the halo above and below, if any
+    const std::uint64_t *above_source = nullptr, *below_source = nullptr;
+    if (rows>0 && Topology::wraps_y(topology)) {
+        above_source = get_row_unchecked(rows-1);
+        below_source = get_row_unchecked(0);
+    } else if (rows>0 && topology==Topology::Type::REFLECT) {
+        above_source = get_row_unchecked(0);
+        below_source = get_row_unchecked(rows-1);
+    }
+    for (unsigned int i = 0; i < words_per_row; i++) {
+        above[i] = above_source ? above_source[i] : 0;
+        below[i] = below_source ? below_source[i] : 0;
+    }
+}
+
+/**
+ * Grid::get_unchecked(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate like Grid::get(x, y), without checking the bounds.
+ * The function should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell, which must be less than the width. Not checked.
+ *
+ * @param y
+ *      The y coordinate of the cell, which must be less than the height. Not checked.
+ *
+ * @return
+ *      The value of the desired cell.
+ */
+
+Cell Grid::get_unchecked(const unsigned int x, const unsigned int y) const {
+    const std::uint64_t word = get_row_unchecked(y)[x/BITS_PER_WORD];
+    return ((word >> (x%BITS_PER_WORD)) & 1U) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * Grid::set_unchecked(x, y, value)
+ *
+ * Overwrites the value at the desired coordinate like Grid::set(x, y, value), without checking the bounds.
+ * Writing outside the grid would corrupt other rows or the padding bits.
+ *
+ * @param x
+ *      The x coordinate of the cell, which must be less than the width. Not checked.
+ *
+ * @param y
+ *      The y coordinate of the cell, which must be less than the height. Not checked.
+ *
+ * @param value
+ *      The value to be written to the selected cell.
+ */
+
+void Grid::set_unchecked(const unsigned int x, const unsigned int y, const Cell value) {
+    CellReference(get_row_unchecked(y)[x/BITS_PER_WORD], std::uint64_t(1) << (x%BITS_PER_WORD), alive_cells) = value;
+}
+
+/**
+ * Grid::crop(x0, y0, x1, y1)
+ *
+ * Extract a sub-grid from a Grid.
+ * The cropped grid spans the range [x0, x1) by [y0, y1) in the original grid.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid y(4, 4);
+ *
+ *      // Crop the centre 2x2 in y, trimming a 1 cell border off all sides
+ *      Grid x = y.crop(x, 1, 1, 3, 3);
+ *
+ * @param x0
+ *      Left coordinate of the crop window on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the crop window on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the crop window on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the crop window on y-axis (1 greater than the largest index).
  *
  * @return
  *      A new grid of the cropped size containing the values extracted from the original grid.
@@ -532,12 +1357,19 @@ const Cell &Grid::operator()(const int x, const int y) const {
 Grid Grid::crop(const int x0,const int y0, const int x1, const int y1) const{
     //if x1,y1 (right,bottom) > x0,y0 (left,top) and within bounds then
     if (x1>x0 && y1>y0 && x0>=0 && y0>=0 && x1<=(int)get_width() && y1<=(int)get_height()) {
-        //Create a new grid and loop through x,y
+        //Create a new grid and copy each row of the window 64 cells at a time
         Grid new_grid = Grid(x1-x0,y1-y0);
         for (unsigned int y = y0; y < (unsigned int)y1; y++) {
-            for (unsigned int x = x0; x < (unsigned int)x1; x++) {
-                //gets value from x,y of current grid and sets it into x-x0,y-y0 of new grid
-                new_grid.set(x-x0,y-y0,get(x,y));
+            const std::uint64_t *row = get_row_unchecked(y);
+            std::uint64_t *new_row = new_grid.get_row_unchecked(y-y0);
+            for (unsigned int i = 0; i < new_grid.words_per_row; i++) {
+                //word i of the new row starts at column x0+64i of the current row
+                new_row[i] = read_bits(row, words_per_row, x0+i*BITS_PER_WORD);
+            }
+            //cells right of x1 must not be left in the padding
+            new_row[new_grid.words_per_row-1] &= new_grid.get_row_mask();
+            for (unsigned int i = 0; i < new_grid.words_per_row; i++) {
+                new_grid.alive_cells += popcount(new_row[i]);
             }
         }
         //returns new grid
@@ -562,6 +1394,8 @@ Grid Grid::crop(const int x0,const int y0, const int x1, const int y1) const{
  *      - If a cell is originally dead it can be updated to be alive from the merge.
  *      - If a cell is originally alive it cannot be updated to be dead from the merge.
  *
+ * Same as Grid::merge(other, x0, y0, Grid::Blend::OVERWRITE) or Grid::merge(other, x0, y0, Grid::Blend::OR).
+ *
  * @example
  *
  *      // Make two grids
@@ -590,35 +1424,220 @@ Grid Grid::crop(const int x0,const int y0, const int x1, const int y1) const{
  *      std::exception or sub-class if the other grid being placed does not fit within the bounds of the current grid.
  */
 
-void Grid::merge(const Grid other, const int x0, const int y0, const bool alive_only) {
+void Grid::merge(const Grid &other, const int x0, const int y0, const bool alive_only) {
+    merge(other, x0, y0, alive_only ? Blend::OR : Blend::OVERWRITE);
+}
+
+/**
+ * Grid::merge(other, x0, y0, mode)
+ *
+ * Merge two grids together by blending the other into the current grid at the desired location.
+ * Each cell within the merge region is combined with the cell of the other grid over it:
+ *      - Grid::Blend::OVERWRITE takes the cell of the other grid.
+ *      - Grid::Blend::OR makes the cell alive if it is alive in the other grid, as alive_only = true.
+ *      - Grid::Blend::XOR flips the cell if it is alive in the other grid.
+ *      - Grid::Blend::AND_NOT kills the cell if it is alive in the other grid, erasing the other grid.
+ *
+ * Rows are blended 64 cells at a time. When x0 is not a multiple of 64 each word of the other grid
+ * is shifted across the two words it lands on. Aligned overwrites copy whole words at once.
+ *
+ * @example
+ *
+ *      // Stamp a glider into a grid, then erase it again
+ *      Grid glider = Zoo::glider(), grid(16, 16);
+ *      grid.merge(glider, 5, 5, Grid::Blend::OR);
+ *      grid.merge(glider, 5, 5, Grid::Blend::AND_NOT);
+ *
+ * @param other
+ *      The other grid to merge into the current grid.
+ *
+ * @param x0
+ *      The x coordinate of where to place the top left corner of the other grid.
+ *
+ * @param y0
+ *      The y coordinate of where to place the top left corner of the other grid.
+ *
+ * @param mode
+ *      How each cell is combined with the cell of the other grid over it.
+ *
+ * @throws
+ *      std::exception or sub-class if the other grid being placed does not fit within the bounds of the current grid.
+ */
+
+void Grid::merge(const Grid &other, const int x0, const int y0, const Blend mode) {
     //set width, height in current x,y to end merging
     const unsigned int other_width = x0+other.get_width();
     const unsigned int other_height = y0+other.get_height();
-    //if within bounds then
+    //if within bounds then blend each row, the whole region was checked here
     if (x0>=0 && y0>=0 && other_width<=get_width() && other_height<=get_height()) {
-        //loop through x0,y0 ending at other width, height
-        Cell value;
         for (unsigned int y = y0; y < other_height; y++) {
-            for (unsigned int x = x0; x < other_width; x++) {
-                //get values from other grid
-                value = other.get(x-x0,y-y0);
-                //if alive_only set to true then 
-                if (alive_only) {
-                    //only set alive cells from other grid to current grid
-                    if (value==Cell::ALIVE) {
-                        set(x,y,Cell::ALIVE);
-                    }
-                //else set dead and alive cells from other grid to current grid
-                } else {
-                    set(x,y,value);
-                }
-            }
+            blend_row(y, x0, other.get_row_unchecked(y-y0), other.get_width(), mode);
         }
     //else throw exception
     } else {
         throw std::out_of_range("Grid::merge out of range.");
     }
+}
+
+/**
+ * Grid::merge(other, x0, y0, alive_only = false)
+ *
+ * Merge a view of a grid into the current grid, exactly as merging the grid holding the view,
+ * without making that grid first.
+ *
+ * @example
+ *
+ *      // Overlay a glider rotated 90 degrees, without making a rotated copy of it
+ *      Grid glider = Zoo::glider(), grid(16, 16);
+ *      grid.merge(GridView(glider).rotate(1), 8, 8, true);
+ *
+ * @param other
+ *      The view to merge into the current grid.
+ *
+ * @param x0
+ *      The x coordinate of where to place the top left corner of the view.
+ *
+ * @param y0
+ *      The y coordinate of where to place the top left corner of the view.
+ *
+ * @param alive_only
+ *      Optional parameter. If true then merging only sets alive cells to alive but does not explicitly set
+ *      dead cells, allowing whatever value was already there to persist. Defaults to false.
+ *
+ * @throws
+ *      std::exception or sub-class if the view being placed does not fit within the bounds of the current grid.
+ */
+
+void Grid::merge(const GridView &other, const int x0, const int y0, const bool alive_only) {
+    merge(other, x0, y0, alive_only ? Blend::OR : Blend::OVERWRITE);
+}
+
+/**
+ * Grid::merge(other, x0, y0, mode)
+ *
+ * Merge a view of a grid into the current grid with the desired blend mode, exactly as merging the
+ * grid holding the view. A view of the current grid itself is copied first, as the rows it reads
+ * may be written by the merge.
+ *
+ * @param other
+ *      The view to merge into the current grid.
+ *
+ * @param x0
+ *      The x coordinate of where to place the top left corner of the view.
+ *
+ * @param y0
+ *      The y coordinate of where to place the top left corner of the view.
+ *
+ * @param mode
+ *      How each cell is combined with the cell of the view over it.
+ *
+ * @throws
+ *      std::exception or sub-class if the view being placed does not fit within the bounds of the current grid.
+ */
+
+void Grid::merge(const GridView &other, const int x0, const int y0, const Blend mode) {
+    if (other.views(*this)) {
+        merge(other.get_grid(), x0, y0, mode);
+        return;
+    }
+    const unsigned int other_width = x0+other.get_width();
+    const unsigned int other_height = y0+other.get_height();
+    if (x0>=0 && y0>=0 && other_width<=get_width() && other_height<=get_height()) {
+        //read each row of the view into words, then blend them as a row of a grid
+        std::vector<std::uint64_t> other_row(other.get_words_per_row());
+        for (unsigned int y = y0; y < other_height; y++) {
+            for (unsigned int i = 0; i < other.get_words_per_row(); i++) {
+                other_row[i] = other.get_word(y-y0, i);
+            }
+            blend_row(y, x0, other_row.data(), other.get_width(), mode);
+        }
+    } else {
+        throw std::out_of_range("Grid::merge out of range.");
+    }
+}
+
+/**
+ * Grid::blend_row(y, x0, other_row, other_width, mode)
+ *
+ * Private helper function to blend a bit-packed row of cells into row y starting at column x0,
+ * a word at a time, keeping the alive count up to date. The row must fit within the grid.
+ *
+ * @param y
+ *      The row of the current grid.
+ *
+ * @param x0
+ *      The column of the current grid where the first cell of the other row lands.
+ *
+ * @param other_row
+ *      The words of the other row, with the bits past other_width set to 0.
+ *
+ * @param other_width
+ *      The number of cells in the other row.
+ *
+ * @param mode
+ *      How each cell is combined with the cell of the other row over it.
+ */
+
+void Grid::blend_row(const unsigned int y, const unsigned int x0, const std::uint64_t *other_row,
+                     const unsigned int other_width, const Blend mode) {
+    std::uint64_t *row = get_row_unchecked(y);
+    const unsigned int first_word = x0/BITS_PER_WORD;
+    const unsigned int shift = x0%BITS_PER_WORD;
+    const unsigned int other_words = (other_width+BITS_PER_WORD-1)/BITS_PER_WORD;
+    //aligned overwrites copy the whole words of the row at once, counting the cells replaced
+    const unsigned int full_words = other_width/BITS_PER_WORD;
+    unsigned int i = 0;
+    if (shift==0 && mode==Blend::OVERWRITE && full_words>0) {
+        std::uint64_t old_alive = 0, new_alive = 0;
+        for (unsigned int j = 0; j < full_words; j++) {
+            old_alive += popcount(row[first_word+j]);
+            new_alive += popcount(other_row[j]);
+        }
+        std::memmove(row+first_word, other_row, (std::size_t) full_words*sizeof(std::uint64_t));
+        alive_cells = alive_cells-old_alive+new_alive;
+        i = full_words;
+    }
+    for (; i < other_words; i++) {
+        //the cells of this word of the other row, all 64 unless it is the last
+        const unsigned int bits = (other_width-i*BITS_PER_WORD<BITS_PER_WORD) ? other_width-i*BITS_PER_WORD : BITS_PER_WORD;
+        const std::uint64_t mask = (bits==BITS_PER_WORD) ? ~0ULL : ((1ULL << bits)-1);
+        const std::uint64_t word = other_row[i];
+        //the word lands on up to two words of the current row
+        for (unsigned int part = 0; part < 2; part++) {
+            std::uint64_t part_word, part_mask;
+            if (part==0) {
+                part_word = word << shift;
+                part_mask = mask << shift;
+            } else {
+                if (shift==0) {
+                    break;
+                }
+                part_word = word >> (BITS_PER_WORD-shift);
+                part_mask = mask >> (BITS_PER_WORD-shift);
+                if (part_mask==0) {
+                    break;
+                }
+            }
+            std::uint64_t &target = row[first_word+i+part];
+            const std::uint64_t old_word = target;
+            switch (mode) {
+                case Blend::OVERWRITE:
+                    target = (old_word & ~part_mask) | (part_word & part_mask);
+                    break;
+                case Blend::OR:
+                    target = old_word | (part_word & part_mask);
+                    break;
+                case Blend::XOR:
+                    target = old_word ^ (part_word & part_mask);
+                    break;
+                case Blend::AND_NOT:
+                    target = old_word & ~(part_word & part_mask);
+                    break;
+            }
+            alive_cells = alive_cells-popcount(old_word)+popcount(target);
+        }
     }
+}
 
 /**
  * Grid::rotate(rotation)
@@ -646,41 +1665,204 @@ void Grid::merge(const Grid other, const int x0, const int y0, const bool alive_
 Grid Grid::rotate(int _rotation) const {
     //sets rotation to be only 0,1,2 or 3
     _rotation = ((_rotation % 4) +4) % 4;
-    //creates new grid and swaps the width and height size if rotation is an odd number
-    Grid new_grid = Grid(get_width(),get_height());
-    if ((_rotation==1) || (_rotation==3)) {
-        new_grid = Grid(get_height(),get_width());
-    }
-    //if rotation is 0 then do nothing
+    //if rotation is 0 then the result is a plain copy
     if (_rotation==0) {
-        new_grid = (*this);
+        return (*this);
+    }
+    //a half turn mirrors both ways, a quarter turn is a transpose mirrored one way
+    if (_rotation==2) {
+        Grid new_grid = (*this);
+        new_grid.mirror_rows();
+        new_grid.flip_rows();
+        return new_grid;
+    }
+    Grid new_grid = transpose();
+    if (_rotation==1) {
+        new_grid.mirror_rows();
     } else {
-        Cell value;
-        unsigned int minus_x, minus_y;
-        //iterate through x,y in new grid
-        for (unsigned int y=0; y < new_grid.get_height(); y++) {
-            for (unsigned int x=0; x < new_grid.get_width(); x++) {
-                //calculates -x,-y to place inside cartesian equations
-                minus_x = new_grid.get_width()-(x+1);
-                minus_y = new_grid.get_height()-(y+1);
-                //if rotation is 1 gets value from current grid rotated 90 degrees clockwise
-                if (_rotation==1) {
-                    value = (*this).get(y, minus_x);
-                //else if rotation is 2 gets value from current grid rotated 180 degrees clockwise
-                } else if (_rotation==2) {
-                    value = (*this).get(minus_x, minus_y);
-                //else get value from current grid rotated 90 degrees counter-clockwise
-                } else {
-                    value = (*this).get(minus_y, x);
-                }
-                //set said value into new grid
-                new_grid.set(x,y,value);
+        new_grid.flip_rows();
+    }
+    //return new grid
+    return new_grid;
+}
+
+/**
+ * Grid::transpose()
+ *
+ * Create a copy of the grid reflected in its leading diagonal, so cell (x, y) of the copy is cell (y, x).
+ * The grid is transposed in blocks of 64x64 cells. Each block is 64 words read from 64 rows, which is
+ * transposed as a bit matrix in registers and written as 64 words to 64 rows, so every word read or
+ * written is used whole and the rows touched by a block stay in cache.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make a 2x5 grid
+ *      Grid x(2, 5);
+ *
+ *      // y is size 5x2
+ *      Grid y = x.transpose();
+ *
+ * @return
+ *      Returns a transposed copy of the grid.
+ */
+
+Grid Grid::transpose() const {
+    Grid new_grid = Grid(get_height(), get_width());
+    std::uint64_t block[BITS_PER_WORD];
+    for (unsigned int ty = 0; ty < new_grid.words_per_row; ty++) {
+        const unsigned int y0 = ty*BITS_PER_WORD;
+        const unsigned int rows = (get_height()-y0<BITS_PER_WORD) ? get_height()-y0 : BITS_PER_WORD;
+        for (unsigned int tx = 0; tx < words_per_row; tx++) {
+            const unsigned int x0 = tx*BITS_PER_WORD;
+            const unsigned int columns = (get_width()-x0<BITS_PER_WORD) ? get_width()-x0 : BITS_PER_WORD;
+            //gather word tx of 64 rows, rows past the bottom are dead
+            for (unsigned int r = 0; r < BITS_PER_WORD; r++) {
+                block[r] = (r<rows) ? get_row_unchecked(y0+r)[tx] : 0;
+            }
+            transpose_block(block);
+            //block[c] is now column x0+c, which is row x0+c of the new grid
+            for (unsigned int c = 0; c < columns; c++) {
+                new_grid.get_row_unchecked(x0+c)[ty] = block[c];
             }
         }
     }
-    //return new grid
+    new_grid.alive_cells = alive_cells;
+    return new_grid;
+}
+
+/**
+ * Grid::reflect_horizontal()
+ *
+ * Create a copy of the grid mirrored left to right, so the first column becomes the last.
+ * Rows are mirrored a word at a time.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      Returns a mirrored copy of the grid.
+ */
+
+Grid Grid::reflect_horizontal() const {
+    Grid new_grid = (*this);
+    new_grid.mirror_rows();
+    return new_grid;
+}
+
+/**
+ * Grid::reflect_vertical()
+ *
+ * Create a copy of the grid mirrored top to bottom, so the first row becomes the last.
+ * Rows are swapped whole.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      Returns a mirrored copy of the grid.
+ */
+
+Grid Grid::reflect_vertical() const {
+    Grid new_grid = (*this);
+    new_grid.flip_rows();
     return new_grid;
-} 
+}
+
+/**
+ * Grid::mirror_rows()
+ *
+ * Private helper function to reverse every row in place, a word at a time.
+ * Reversing the words of a row and the bits of each word puts column x at 64 * words_per_row - 1 - x,
+ * so the row is then shifted down by the padding to put it at width - 1 - x, with 0 bits shifted in.
+ */
+
+void Grid::mirror_rows() {
+    const unsigned int padding = words_per_row*BITS_PER_WORD-get_width();
+    for (unsigned int y = 0; y < get_height(); y++) {
+        std::uint64_t *row = get_row_unchecked(y);
+        for (unsigned int i = 0; i < words_per_row/2; i++) {
+            const std::uint64_t word = row[i];
+            row[i] = reverse_bits(row[words_per_row-1-i]);
+            row[words_per_row-1-i] = reverse_bits(word);
+        }
+        if (words_per_row%2==1) {
+            row[words_per_row/2] = reverse_bits(row[words_per_row/2]);
+        }
+        if (padding!=0) {
+            for (unsigned int i = 0; i < words_per_row; i++) {
+                row[i] = (row[i] >> padding) | ((i+1<words_per_row) ? row[i+1] << (BITS_PER_WORD-padding) : 0);
+            }
+        }
+    }
+}
+
+/**
+ * Grid::flip_rows()
+ *
+ * Private helper function to reverse the order of the rows in place, swapping whole rows of words.
+ */
+
+void Grid::flip_rows() {
+    for (unsigned int y = 0; y < get_height()/2; y++) {
+        std::uint64_t *top = get_row_unchecked(y);
+        std::uint64_t *bottom = get_row_unchecked(get_height()-1-y);
+        for (unsigned int i = 0; i < words_per_row; i++) {
+            std::swap(top[i], bottom[i]);
+        }
+    }
+}
+
+/**
+ * Grid::operator==(other)
+ *
+ * Compares two grids cell by cell, one storage word at a time.
+ * The operator should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make two grids
+ *      Grid x(4, 4), y(4, 4);
+ *
+ *      // Grids of the same size with the same cells are equal
+ *      bool same = (x == y);
+ *
+ * @param other
+ *      The grid to compare against.
+ *
+ * @return
+ *      True if both grids have the same width, height, and cells.
+ */
+
+bool Grid::operator==(const Grid &other) const {
+    if (get_width()!=other.get_width() || get_height()!=other.get_height()
+        || get_alive_cells()!=other.get_alive_cells()) {
+        return false;
+    }
+    //padding bits are always 0 so whole rows of words can be compared
+    for (unsigned int y = 0; y < get_height(); y++) {
+        const std::uint64_t *row = get_row_unchecked(y), *other_row = other.get_row_unchecked(y);
+        for (unsigned int i = 0; i < get_words_per_row(); i++) {
+            if (row[i]!=other_row[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Grid::operator!=(other)
+ *
+ * Compares two grids cell by cell, the negation of Grid::operator==(other).
+ * The operator should be callable from a constant context.
+ *
+ * @param other
+ *      The grid to compare against.
+ *
+ * @return
+ *      True if the grids differ in size or in any cell.
+ */
+
+bool Grid::operator!=(const Grid &other) const {
+    return !((*this)==other);
+}
 
 /**
  * operator<<(output_stream, grid)
@@ -718,26 +1900,7 @@ Grid Grid::rotate(int _rotation) const {
  *      Returns a reference to the output stream to enable operator chaining.
  */
 
-std::ostream &operator<<(std::ostream &os, const Grid grid) {
-    //creates top wrapper
-    os << '+' << std::string(grid.get_width(), '-') << '+' << std::endl;
-    //iterates through x,y of grid parameter
-    for (unsigned int y = 0; y < grid.get_height(); y++) {
-        //creates left wrapper
-        os << '|';
-        for (unsigned int x = 0; x < grid.get_width(); x++) {
-            //if value in current grid is alive then output a hash
-            if (grid.get(x,y)==Cell::ALIVE) {
-                os << '#';
-            //else output a space
-            } else {
-                os << ' ';
-            }
-        }
-        //creates right wrapper
-        os << '|' << std::endl;
-    }
-    //creates bottom wrapper
-    os << '+' << std::string(grid.get_width(), '-') << '+' << std::endl;
-	return os;
+std::ostream &operator<<(std::ostream &os, const Grid &grid) {
+    //a view of the whole grid prints the same, a word at a time
+    return os << GridView(grid);
 }
\ No newline at end of file
@@ -12,9 +12,16 @@
 
 // Add the minimal number of includes you need in order to declare the class.
 // #include ...
+#include "topology.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <ostream>
 
+class GridView;
+class MappedFile;
+
 /**
  * A Cell is a char limited to two named values for Cell::DEAD and Cell::ALIVE.
  */
@@ -25,32 +32,117 @@ enum Cell : char {
 
 /**
  * Declare the structure of the Grid class for representing a 2d grid of cells.
+ *
+ * Cells are bit-packed, each row is stored as a run of 64 bit words where bit (x % 64) of
+ * word (x / 64) holds the cell at column x. Bits past the width of the grid are always 0.
+ *
+ * The *_unchecked accessors skip bounds checks for callers that have already validated the region.
+ * The number of alive cells is kept up to date as cells are written, so it can be read in O(1) time.
+ * Optionally a halo row is kept above and below the cells, which the step engine fills before each step.
+ * Cell counts and indices are 64 bit, so a grid may hold more than 2^32 cells.
+ * Like an std::vector, the storage may be larger than the grid, with rows row_stride words apart and room
+ * for row_capacity rows, so resizing within that capacity happens in place.
+ * The words are held in an std::vector, or in a region of a memory mapped file for grids larger than RAM.
  */
 class Grid {
     private:
         unsigned int width;
         unsigned int height;
-        std::vector<Cell> cells;
-        unsigned int get_index(const unsigned int x, const unsigned int y) const;
+        unsigned int words_per_row;
+        unsigned int row_stride;
+        unsigned int row_capacity;
+        std::vector<std::uint64_t> words;
+        std::shared_ptr<MappedFile> mapping;
+        std::uint64_t *data;
+        std::uint64_t alive_cells;
+        unsigned int halo_rows;
+        std::size_t get_num_words() const;
+        std::uint64_t get_index(const unsigned int x, const unsigned int y) const;
+        void relayout(const unsigned int new_row_stride, const unsigned int new_row_capacity,
+                      const unsigned int new_halo_rows);
     public:
+        /**
+         * A modifiable reference to a single bit-packed cell, returned by Grid::operator()(x, y).
+         */
+        class CellReference {
+            private:
+                std::uint64_t &word;
+                const std::uint64_t mask;
+                std::uint64_t &alive_cells;
+            public:
+                CellReference(std::uint64_t &word, const std::uint64_t mask, std::uint64_t &alive_cells);
+                operator Cell() const;
+                CellReference &operator=(const Cell value);
+                CellReference &operator=(const CellReference &other);
+        };
+
+        /**
+         * The ways Grid::merge can combine each cell with the cell of the other grid placed over it.
+         */
+        enum class Blend {
+            OVERWRITE,
+            OR,
+            XOR,
+            AND_NOT
+        };
+
+        static const unsigned int BITS_PER_WORD = 64;
+
         Grid();
         explicit Grid(const unsigned int square_size);
         Grid(const unsigned int width, const unsigned int height);
+        Grid(const std::shared_ptr<MappedFile> &mapping, const std::size_t offset,
+             const unsigned int width, const unsigned int height);
+        Grid(const Grid &other);
+        Grid(Grid &&other) noexcept;
         ~Grid();
+        Grid &operator=(const Grid &other);
+        Grid &operator=(Grid &&other) noexcept;
+
+        static std::uint64_t reverse_bits(std::uint64_t word);
+        static std::size_t get_mapped_size(const unsigned int width, const unsigned int height);
+        bool is_mapped() const;
 
         unsigned int get_width() const;
         unsigned int get_height() const;
-        unsigned int get_total_cells() const;
-        unsigned int get_alive_cells() const;
-        unsigned int get_dead_cells() const;
+        std::uint64_t get_total_cells() const;
+        std::uint64_t get_alive_cells() const;
+        std::uint64_t get_dead_cells() const;
+        void set_alive_cells(const std::uint64_t alive_cells);
+        void recount_alive_cells();
         void resize(const unsigned int square_size);
         void resize(const unsigned int width, const unsigned int height);
+        void reserve(const unsigned int width, const unsigned int height);
         Cell get(const int x, const int y) const;
         void set(const int x, const int y, const Cell value);
-        Cell &operator()(const int x, const int y);
-        const Cell &operator()(const int x, const int y) const;
+        CellReference operator()(const int x, const int y);
+        Cell operator()(const int x, const int y) const;
+        unsigned int get_words_per_row() const;
+        std::uint64_t *get_row(const int y);
+        const std::uint64_t *get_row(const int y) const;
+        std::uint64_t get_row_mask() const;
+        std::uint64_t *get_row_unchecked(const int y);
+        const std::uint64_t *get_row_unchecked(const int y) const;
+        bool has_halo() const;
+        void set_halo(const bool halo);
+        void fill_halo(const Topology::Type topology);
+        Cell get_unchecked(const unsigned int x, const unsigned int y) const;
+        void set_unchecked(const unsigned int x, const unsigned int y, const Cell value);
         Grid crop(const int x0, const int y0, const int x1, const int y1) const;
-        void merge(const Grid other, const int x0, const int y0, const bool alive_only=false);
+        void merge(const Grid &other, const int x0, const int y0, const bool alive_only=false);
+        void merge(const GridView &other, const int x0, const int y0, const bool alive_only=false);
+        void merge(const Grid &other, const int x0, const int y0, const Blend mode);
+        void merge(const GridView &other, const int x0, const int y0, const Blend mode);
         Grid rotate(int _rotation) const;
-        friend std::ostream &operator<<(std::ostream &os, const Grid grid);
+        Grid transpose() const;
+        Grid reflect_horizontal() const;
+        Grid reflect_vertical() const;
+        bool operator==(const Grid &other) const;
+        bool operator!=(const Grid &other) const;
+        friend std::ostream &operator<<(std::ostream &os, const Grid &grid);
+    private:
+        void mirror_rows();
+        void flip_rows();
+        void blend_row(const unsigned int y, const unsigned int x0, const std::uint64_t *other_row,
+                       const unsigned int other_width, const Blend mode);
 };
@@ -0,0 +1,541 @@
+/**
+ * Implements a class representing a lazy, read only view of a transformed region of a Grid.
+ *      - Views are made from a grid, then cropped, rotated, transposed, reflected, and offset
+ *        any number of times. Each of these takes O(1) time and copies no cells.
+ *          - A view is an affine map from its cells to the cells of the grid, with a clip rectangle in the
+ *            grid outside of which every cell reads as dead. Each operation composes a new map and clip.
+ *          - Offsetting a view moves its contents within the same size, the cells moved in are dead.
+ *
+ *      - Views are read where they are used, by Grid::merge, World::World, Zoo::save_ascii,
+ *        Zoo::save_binary, and operator<<, and are only copied into a new Grid by GridView::get_grid().
+ *          - GridView::get_word(y, i) reads 64 cells of a row as one word, bit-packed as in Grid.
+ *            Views that keep the rows of the grid as rows, crops, offsets, and reflections, are read
+ *            a word at a time. Views that turn columns into rows are read a cell at a time.
+ *
+ *      - Views do not own their grid. The grid must outlive the view and must not be resized while it is
+ *        viewed. Views cannot be made from a temporary grid.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "grid_view.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include "grid.h"
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+
+/**
+ * GridView::GridView(grid)
+ *
+ * Construct a view of the whole of a grid, as it is.
+ *
+ * @example
+ *
+ *      // Make a grid and view it rotated, without copying it
+ *      Grid glider = Zoo::glider();
+ *      GridView rotated = GridView(glider).rotate(1);
+ *
+ *      // This should be a compiler error! The temporary grid would be gone before the view is used.
+ *      GridView bad_view(Zoo::glider());
+ *
+ * @param grid
+ *      The grid to view, which must outlive the view.
+ */
+
+GridView::GridView(const Grid &grid): grid(&grid), width(grid.get_width()), height(grid.get_height()),
+    origin_x(0), origin_y(0), xx(1), xy(0), yx(0), yy(1),
+    clip_x0(0), clip_y0(0), clip_x1(grid.get_width()), clip_y1(grid.get_height()) {
+}
+
+/**
+ * GridView::map(x0, y0, x1, y1, a, b, c, d, e, f, new_width, new_height)
+ *
+ * Private helper function to make a new view whose cell (x, y) is the cell (a + b*x + c*y, d + e*x + f*y)
+ * of this view, where only the region x0 <= x < x1, y0 <= y < y1 of this view can be seen through it.
+ *
+ * @return
+ *      The new view of the same grid.
+ */
+
+GridView GridView::map(const unsigned int x0, const unsigned int y0, const unsigned int x1, const unsigned int y1,
+                       const std::int64_t a, const int b, const int c, const std::int64_t d, const int e, const int f,
+                       const unsigned int new_width, const unsigned int new_height) const {
+    GridView view = (*this);
+    view.width = new_width;
+    view.height = new_height;
+    //compose the map of this view with the new one
+    view.origin_x = origin_x+xx*a+xy*d;
+    view.origin_y = origin_y+yx*a+yy*d;
+    view.xx = xx*b+xy*e;
+    view.xy = xx*c+xy*f;
+    view.yx = yx*b+yy*e;
+    view.yy = yx*c+yy*f;
+    //narrow the clip to the part of the grid under the region, found from two opposite corners
+    if (x0>=x1 || y0>=y1) {
+        view.clip_x0 = view.clip_x1 = view.clip_y0 = view.clip_y1 = 0;
+        return view;
+    }
+    const std::int64_t ax = origin_x+xx*(std::int64_t) x0+xy*(std::int64_t) y0;
+    const std::int64_t ay = origin_y+yx*(std::int64_t) x0+yy*(std::int64_t) y0;
+    const std::int64_t bx = origin_x+xx*(std::int64_t) (x1-1)+xy*(std::int64_t) (y1-1);
+    const std::int64_t by = origin_y+yx*(std::int64_t) (x1-1)+yy*(std::int64_t) (y1-1);
+    const std::int64_t region_x0 = (ax<bx) ? ax : bx, region_x1 = ((ax<bx) ? bx : ax)+1;
+    const std::int64_t region_y0 = (ay<by) ? ay : by, region_y1 = ((ay<by) ? by : ay)+1;
+    view.clip_x0 = (clip_x0>region_x0) ? clip_x0 : region_x0;
+    view.clip_y0 = (clip_y0>region_y0) ? clip_y0 : region_y0;
+    view.clip_x1 = (clip_x1<region_x1) ? clip_x1 : region_x1;
+    view.clip_y1 = (clip_y1<region_y1) ? clip_y1 : region_y1;
+    return view;
+}
+
+/**
+ * GridView::get_width()
+ *
+ * Gets the width of the view.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The width of the view.
+ */
+
+unsigned int GridView::get_width() const {
+    return width;
+}
+
+/**
+ * GridView::get_height()
+ *
+ * Gets the height of the view.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The height of the view.
+ */
+
+unsigned int GridView::get_height() const {
+    return height;
+}
+
+/**
+ * GridView::get_total_cells()
+ *
+ * Gets the total number of cells in the view, alive or dead.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of cells in the view.
+ */
+
+std::uint64_t GridView::get_total_cells() const {
+    return (std::uint64_t) width*height;
+}
+
+/**
+ * GridView::get_words_per_row()
+ *
+ * Gets the number of 64 bit words needed to hold a row of the view, as in Grid::get_words_per_row().
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of words per row.
+ */
+
+unsigned int GridView::get_words_per_row() const {
+    return (width+Grid::BITS_PER_WORD-1)/Grid::BITS_PER_WORD;
+}
+
+/**
+ * GridView::get_word(y, i)
+ *
+ * Reads the 64 cells of row y starting at column 64i as one word, bit (x % 64) holding column x,
+ * exactly as word i of row y of a Grid holding the view would be. Bits past the width are 0.
+ * Does not check bounds, the caller must ensure y < height and i < words per row.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Copy a row of a view a word at a time
+ *      GridView view = GridView(grid).crop(3, 3, 200, 200);
+ *      for (unsigned int i = 0; i < view.get_words_per_row(); i++) {
+ *          row[i] = view.get_word(0, i);
+ *      }
+ *
+ * @param y
+ *      The row of the view.
+ *
+ * @param i
+ *      The word of the row.
+ *
+ * @return
+ *      The cells as a bit-packed word.
+ */
+
+std::uint64_t GridView::get_word(const unsigned int y, const unsigned int i) const {
+    const unsigned int first_x = i*Grid::BITS_PER_WORD;
+    const unsigned int num_bits = (width-first_x<Grid::BITS_PER_WORD) ? width-first_x : Grid::BITS_PER_WORD;
+    const std::uint64_t mask = (num_bits==Grid::BITS_PER_WORD) ? ~0ULL : ((1ULL << num_bits)-1);
+    //columns of the view run along columns of the grid, so the cells are a run of a grid row
+    if (xx!=0) {
+        const std::int64_t grid_y = origin_y+yy*(std::int64_t) y;
+        if (grid_y<clip_y0 || grid_y>=clip_y1) {
+            return 0;
+        }
+        //the lowest grid column of the 64, read upwards and reversed if the view runs right to left
+        const std::int64_t lo = origin_x+xx*(std::int64_t) first_x-((xx<0) ? Grid::BITS_PER_WORD-1 : 0);
+        if (lo>=clip_x1 || lo+(std::int64_t) Grid::BITS_PER_WORD<=clip_x0) {
+            return 0;
+        }
+        const std::uint64_t *row = grid->get_row_unchecked(grid_y);
+        std::uint64_t bits;
+        if (lo>=0) {
+            const unsigned int word = lo/Grid::BITS_PER_WORD;
+            const unsigned int shift = lo%Grid::BITS_PER_WORD;
+            bits = row[word] >> shift;
+            if (shift!=0 && word+1<grid->get_words_per_row()) {
+                bits |= row[word+1] << (Grid::BITS_PER_WORD-shift);
+            }
+        } else {
+            bits = row[0] << (-lo);
+        }
+        //drop the cells outside the clip
+        const std::int64_t low = (clip_x0>lo) ? clip_x0-lo : 0;
+        const std::int64_t high = (clip_x1-lo<(std::int64_t) Grid::BITS_PER_WORD) ? clip_x1-lo : Grid::BITS_PER_WORD;
+        bits &= ((high==(std::int64_t) Grid::BITS_PER_WORD) ? ~0ULL : ((1ULL << high)-1)) & (~0ULL << low);
+        if (xx<0) {
+            bits = Grid::reverse_bits(bits);
+        }
+        return bits & mask;
+    }
+    //otherwise the cells are a run of a grid column, gathered one at a time
+    std::uint64_t bits = 0;
+    for (unsigned int b = 0; b < num_bits; b++) {
+        if (get_unchecked(first_x+b, y)==Cell::ALIVE) {
+            bits |= 1ULL << b;
+        }
+    }
+    return bits;
+}
+
+/**
+ * GridView::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate of the view.
+ * The function should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell to read.
+ *
+ * @param y
+ *      The y coordinate of the cell to read.
+ *
+ * @return
+ *      The value of the cell, or Cell::DEAD if it is outside the clip of the view.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the view.
+ */
+
+Cell GridView::get(const int x, const int y) const {
+    if (x>=0 && y>=0 && x<(int) width && y<(int) height) {
+        return get_unchecked(x, y);
+    }
+    throw std::out_of_range("GridView::get out of range.");
+}
+
+/**
+ * GridView::get_unchecked(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate of the view, without checking bounds.
+ * The caller must ensure x < width and y < height.
+ * The function should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell to read.
+ *
+ * @param y
+ *      The y coordinate of the cell to read.
+ *
+ * @return
+ *      The value of the cell, or Cell::DEAD if it is outside the clip of the view.
+ */
+
+Cell GridView::get_unchecked(const unsigned int x, const unsigned int y) const {
+    const std::int64_t grid_x = origin_x+xx*(std::int64_t) x+xy*(std::int64_t) y;
+    const std::int64_t grid_y = origin_y+yx*(std::int64_t) x+yy*(std::int64_t) y;
+    if (grid_x<clip_x0 || grid_x>=clip_x1 || grid_y<clip_y0 || grid_y>=clip_y1) {
+        return Cell::DEAD;
+    }
+    return grid->get_unchecked(grid_x, grid_y);
+}
+
+/**
+ * GridView::operator()(x, y)
+ *
+ * Gets the value of the cell at the desired coordinate of the view, as GridView::get(x, y).
+ * Views are read only, so there is no modifiable version.
+ *
+ * @param x
+ *      The x coordinate of the cell to read.
+ *
+ * @param y
+ *      The y coordinate of the cell to read.
+ *
+ * @return
+ *      The value of the cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the view.
+ */
+
+Cell GridView::operator()(const int x, const int y) const {
+    return get(x, y);
+}
+
+/**
+ * GridView::crop(x0, y0, x1, y1)
+ *
+ * Views a rectangular region of the view, with the same bounds rules as Grid::crop.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // View the middle 2x2 of a 4x4 grid
+ *      Grid grid(4);
+ *      GridView middle = GridView(grid).crop(1, 1, 3, 3);
+ *
+ * @param x0
+ *      The x coordinate of the top left corner of the window (inclusive).
+ *
+ * @param y0
+ *      The y coordinate of the top left corner of the window (inclusive).
+ *
+ * @param x1
+ *      The x coordinate of the bottom right corner of the window (exclusive).
+ *
+ * @param y1
+ *      The y coordinate of the bottom right corner of the window (exclusive).
+ *
+ * @return
+ *      A view of the region.
+ *
+ * @throws
+ *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the view
+ *      or if the crop window has a negative size.
+ */
+
+GridView GridView::crop(const int x0, const int y0, const int x1, const int y1) const {
+    if (x1>x0 && y1>y0 && x0>=0 && y0>=0 && x1<=(int) width && y1<=(int) height) {
+        return map(x0, y0, x1, y1, x0, 1, 0, y0, 0, 1, x1-x0, y1-y0);
+    }
+    if (x1<x0 || y1<y0) {
+        throw std::runtime_error("GridView::crop invalid parameters.");
+    }
+    throw std::out_of_range("GridView::crop out of range.");
+}
+
+/**
+ * GridView::rotate(rotation)
+ *
+ * Views the view rotated by a multiple of 90 degrees clockwise, as Grid::rotate(rotation).
+ * The rotation can be any integer, positive, negative, or 0.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // View a 1x3 grid as a 3x1 view
+ *      Grid grid(1, 3);
+ *      GridView view = GridView(grid).rotate(1);
+ *
+ * @param _rotation
+ *      An positive or negative integer to rotate by in 90 intervals.
+ *
+ * @return
+ *      A rotated view.
+ */
+
+GridView GridView::rotate(int _rotation) const {
+    _rotation = ((_rotation % 4) +4) % 4;
+    const std::int64_t w = width, h = height;
+    if (_rotation==1) {
+        return map(0, 0, width, height, 0, 0, 1, h-1, -1, 0, height, width);
+    } else if (_rotation==2) {
+        return map(0, 0, width, height, w-1, -1, 0, h-1, 0, -1, width, height);
+    } else if (_rotation==3) {
+        return map(0, 0, width, height, w-1, 0, -1, 0, 1, 0, height, width);
+    }
+    return (*this);
+}
+
+/**
+ * GridView::transpose()
+ *
+ * Views the view reflected in its leading diagonal, so cell (x, y) is the cell (y, x) of this view.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A transposed view, with the width and height swapped.
+ */
+
+GridView GridView::transpose() const {
+    return map(0, 0, width, height, 0, 0, 1, 0, 1, 0, height, width);
+}
+
+/**
+ * GridView::reflect_horizontal()
+ *
+ * Views the view mirrored left to right, so the first column becomes the last.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A mirrored view of the same size.
+ */
+
+GridView GridView::reflect_horizontal() const {
+    return map(0, 0, width, height, (std::int64_t) width-1, -1, 0, 0, 0, 1, width, height);
+}
+
+/**
+ * GridView::reflect_vertical()
+ *
+ * Views the view mirrored top to bottom, so the first row becomes the last.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A mirrored view of the same size.
+ */
+
+GridView GridView::reflect_vertical() const {
+    return map(0, 0, width, height, 0, 1, 0, (std::int64_t) height-1, 0, -1, width, height);
+}
+
+/**
+ * GridView::offset(dx, dy)
+ *
+ * Views the view with its contents moved right by dx and down by dy, keeping the same size.
+ * Cells moved out over the edges are lost, and the cells moved in are dead.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // View a grid with its contents moved one cell up and to the left
+ *      GridView moved = GridView(grid).offset(-1, -1);
+ *
+ * @param dx
+ *      The number of columns to move right, negative to move left.
+ *
+ * @param dy
+ *      The number of rows to move down, negative to move up.
+ *
+ * @return
+ *      An offset view of the same size.
+ */
+
+GridView GridView::offset(const int dx, const int dy) const {
+    return map(0, 0, width, height, -(std::int64_t) dx, 1, 0, -(std::int64_t) dy, 0, 1, width, height);
+}
+
+/**
+ * GridView::get_grid()
+ *
+ * Materializes the view, copying its cells into a new grid a word at a time.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make a rotated copy of part of a grid
+ *      Grid copy = GridView(grid).crop(0, 0, 8, 8).rotate(1).get_grid();
+ *
+ * @return
+ *      A grid the size of the view holding its cells.
+ */
+
+Grid GridView::get_grid() const {
+    Grid new_grid(width, height);
+    for (unsigned int y = 0; y < height; y++) {
+        std::uint64_t *row = new_grid.get_row_unchecked(y);
+        for (unsigned int i = 0; i < get_words_per_row(); i++) {
+            row[i] = get_word(y, i);
+        }
+    }
+    new_grid.recount_alive_cells();
+    return new_grid;
+}
+
+/**
+ * GridView::views(grid)
+ *
+ * Checks if the view reads its cells from the given grid, so writes to that grid may change the view.
+ * The function should be callable from a constant context.
+ *
+ * @param grid
+ *      The grid to check.
+ *
+ * @return
+ *      True if the view is of that very grid.
+ */
+
+bool GridView::views(const Grid &grid) const {
+    return this->grid==&grid;
+}
+
+/**
+ * write_dashes(os, dashes, count)
+ *
+ * Helper to write count - (dash) characters for a border, a word of them at a time from a buffer of dashes.
+ */
+
+static void write_dashes(std::ostream &os, const char dashes[Grid::BITS_PER_WORD], const unsigned int count) {
+    for (unsigned int x = 0; x < count; x += Grid::BITS_PER_WORD) {
+        os.write(dashes, (count-x<Grid::BITS_PER_WORD) ? count-x : Grid::BITS_PER_WORD);
+    }
+}
+
+/**
+ * operator<<(output_stream, view)
+ *
+ * Serializes a view to an ascii output stream, exactly as operator<<(output_stream, grid) would
+ * print the grid holding the view.
+ *
+ * @param os
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param view
+ *      A view of the cells to be printed.
+ *
+ * @return
+ *      Returns a reference to the output stream to enable operator chaining.
+ */
+
+std::ostream &operator<<(std::ostream &os, const GridView &view) {
+    //rows are written a word of cells at a time from a buffer on the stack, so printing allocates nothing
+    char cells[Grid::BITS_PER_WORD];
+    std::fill(cells, cells+Grid::BITS_PER_WORD, '-');
+    //creates top wrapper
+    os << '+';
+    write_dashes(os, cells, view.get_width());
+    os << '+' << std::endl;
+    for (unsigned int y = 0; y < view.get_height(); y++) {
+        os << '|';
+        for (unsigned int i = 0; i < view.get_words_per_row(); i++) {
+            const std::uint64_t word = view.get_word(y, i);
+            const unsigned int first_x = i*Grid::BITS_PER_WORD;
+            const unsigned int count = (view.get_width()-first_x<Grid::BITS_PER_WORD) ? view.get_width()-first_x
+                                                                                       : Grid::BITS_PER_WORD;
+            for (unsigned int x = 0; x < count; x++) {
+                cells[x] = ((word >> x) & 1U) ? '#' : ' ';
+            }
+            os.write(cells, count);
+        }
+        os << '|' << std::endl;
+    }
+    //creates bottom wrapper
+    std::fill(cells, cells+Grid::BITS_PER_WORD, '-');
+    os << '+';
+    write_dashes(os, cells, view.get_width());
+    os << '+' << std::endl;
+    return os;
+}
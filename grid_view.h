@@ -0,0 +1,63 @@
+/**
+ * Declares a class representing a lazy, read only view of a transformed region of a Grid.
+ * Rich documentation for the api and behaviour the GridView class can be found in grid_view.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the class.
+// #include ...
+#include "grid.h"
+#include <cstdint>
+#include <ostream>
+/**
+ * Declare the structure of the GridView class for reading crops, rotations, reflections, and offsets
+ * of a Grid without copying its cells.
+ *
+ * Cell (x, y) of the view is the cell (origin_x + xx*x + xy*y, origin_y + yx*x + yy*y) of the grid,
+ * if that cell is within the clip rectangle of the grid, and is dead otherwise.
+ * The view does not own the grid, which must outlive it and any view made from it.
+ */
+class GridView {
+    private:
+        const Grid *grid;
+        unsigned int width;
+        unsigned int height;
+        std::int64_t origin_x;
+        std::int64_t origin_y;
+        int xx;
+        int xy;
+        int yx;
+        int yy;
+        std::int64_t clip_x0;
+        std::int64_t clip_y0;
+        std::int64_t clip_x1;
+        std::int64_t clip_y1;
+        GridView map(const unsigned int x0, const unsigned int y0, const unsigned int x1, const unsigned int y1,
+                     const std::int64_t a, const int b, const int c, const std::int64_t d, const int e, const int f,
+                     const unsigned int new_width, const unsigned int new_height) const;
+    public:
+        explicit GridView(const Grid &grid);
+        GridView(const Grid &&grid) = delete;
+
+        unsigned int get_width() const;
+        unsigned int get_height() const;
+        std::uint64_t get_total_cells() const;
+        unsigned int get_words_per_row() const;
+        std::uint64_t get_word(const unsigned int y, const unsigned int i) const;
+        Cell get(const int x, const int y) const;
+        Cell get_unchecked(const unsigned int x, const unsigned int y) const;
+        Cell operator()(const int x, const int y) const;
+        GridView crop(const int x0, const int y0, const int x1, const int y1) const;
+        GridView rotate(int _rotation) const;
+        GridView transpose() const;
+        GridView reflect_horizontal() const;
+        GridView reflect_vertical() const;
+        GridView offset(const int dx, const int dy) const;
+        Grid get_grid() const;
+        bool views(const Grid &grid) const;
+};
+
+std::ostream &operator<<(std::ostream &os, const GridView &view);
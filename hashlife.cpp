@@ -0,0 +1,641 @@
+/**
+ * Implements a class representing an unbounded Game of Life universe stored as a hash-consed quadtree.
+ *      - https://en.wikipedia.org/wiki/Hashlife
+ *
+ *      - The universe is a square node of 2^level by 2^level cells, split into four quadrant nodes of the
+ *        level below, down to level 0 nodes which are single cells.
+ *          - Nodes are hash-consed, every distinct square of cells is stored exactly once and shared by
+ *            every place it appears, so repetitive and empty space costs almost nothing.
+ *          - Nodes never change once made, so node pointers can be compared to compare squares of cells.
+ *
+ *      - The future of a node is memoized. For a node of level k the centre square of level k - 1 is fully
+ *        decided 2^j generations ahead for any j <= k - 2, as no information travels faster than 1 cell
+ *        per generation. HashLife::successor computes and remembers this result for each node and j,
+ *        by combining the results of its overlapping sub-squares.
+ *          - Once a pattern repeats itself in space or time its results are reused rather than recomputed,
+ *            so advancing takes time that grows with the complexity of the pattern, not the generations.
+ *
+ *      - HashLife::advance(steps) breaks steps into powers of two and advances by each in turn, growing
+ *        the universe with empty space first so nothing can move out of the centre being kept.
+ *
+ *      - Universes are loaded from a Grid, whose top left cell is at coordinate (0, 0), and any window
+ *        of the universe can be exported back to a Grid.
+ *          - The universe is unbounded, cells are not lost or wrapped at the edges of the original grid.
+ *
+ *      - Universes follow Conway's Game of Life, or another Life-like rule set by HashLife::set_rule.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "hashlife.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include "grid.h"
+#include "rule.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * mix(hash, value)
+ *
+ * Helper to combine a pointer sized value into a running hash.
+ */
+
+static std::size_t mix(const std::size_t hash, const std::uintptr_t value) {
+    return (hash ^ (value >> 4)) * 0x9E3779B97F4A7C15ULL;
+}
+
+bool HashLife::NodeKey::operator==(const NodeKey &other) const {
+    return nw==other.nw && ne==other.ne && sw==other.sw && se==other.se;
+}
+
+std::size_t HashLife::NodeKeyHash::operator()(const NodeKey &key) const {
+    std::size_t hash = 0;
+    hash = mix(hash, (std::uintptr_t) key.nw);
+    hash = mix(hash, (std::uintptr_t) key.ne);
+    hash = mix(hash, (std::uintptr_t) key.sw);
+    hash = mix(hash, (std::uintptr_t) key.se);
+    return hash ^ (hash >> 29);
+}
+
+bool HashLife::ResultKey::operator==(const ResultKey &other) const {
+    return node==other.node && step_level==other.step_level;
+}
+
+std::size_t HashLife::ResultKeyHash::operator()(const ResultKey &key) const {
+    const std::size_t hash = mix(0, (std::uintptr_t) key.node)+key.step_level*0x632BE59BD9B4E019ULL;
+    return hash ^ (hash >> 29);
+}
+
+/**
+ * HashLife::HashLife()
+ *
+ * Construct an empty universe.
+ *
+ * @example
+ *
+ *      // Make an empty universe
+ *      HashLife life;
+ *
+ */
+
+HashLife::HashLife(): HashLife(Grid()) {
+}
+
+/**
+ * HashLife::HashLife(grid)
+ *
+ * Construct a universe holding the alive cells of a grid, with the top left cell of the grid at (0, 0).
+ * Everywhere outside of the grid is dead.
+ *
+ * @example
+ *
+ *      // Make a universe holding an r-pentomino
+ *      HashLife life(Zoo::r_pentomino());
+ *
+ * @param grid
+ *      The grid to load.
+ */
+
+HashLife::HashLife(const Grid &grid): origin_x(0), origin_y(0), generation(0) {
+    //the two level 0 nodes, a dead and an alive cell
+    nodes.push_back(Node{nullptr, nullptr, nullptr, nullptr, 0, 0});
+    dead_cell = &nodes.back();
+    nodes.push_back(Node{nullptr, nullptr, nullptr, nullptr, 0, 1});
+    alive_cell = &nodes.back();
+    empty_nodes.push_back(dead_cell);
+    //smallest square of at least level 3 covering the grid
+    unsigned int level = 3;
+    while ((std::uint64_t(1) << level) < grid.get_width() || (std::uint64_t(1) << level) < grid.get_height()) {
+        level++;
+    }
+    root = build(grid, 0, 0, level);
+}
+
+/**
+ * HashLife::get_population()
+ *
+ * Gets the number of alive cells in the universe.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+
+std::uint64_t HashLife::get_population() const {
+    return root->population;
+}
+
+/**
+ * HashLife::get_generation()
+ *
+ * Gets the number of generations the universe has been advanced by since it was loaded.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The generation of the universe.
+ */
+
+std::uint64_t HashLife::get_generation() const {
+    return generation;
+}
+
+/**
+ * HashLife::get_num_nodes()
+ *
+ * Gets the number of distinct nodes stored, a measure of the memory in use.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of nodes.
+ */
+
+std::size_t HashLife::get_num_nodes() const {
+    return nodes.size();
+}
+
+/**
+ * HashLife::get_rule()
+ *
+ * Gets the rule the universe is stepped with.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The rule in use, Rule::conway() unless changed by HashLife::set_rule.
+ */
+
+const Rule &HashLife::get_rule() const {
+    return rule;
+}
+
+/**
+ * HashLife::set_rule(rule)
+ *
+ * Sets the Life-like rule the universe is stepped with.
+ * The remembered futures of the nodes were found under the old rule, so they are forgotten.
+ *
+ * @example
+ *
+ *      // Advance an r-pentomino a million generations of HighLife
+ *      HashLife life(Zoo::r_pentomino());
+ *      life.set_rule(Rule::highlife());
+ *      life.advance(1000000);
+ *
+ * @param rule
+ *      The rule to use.
+ */
+
+void HashLife::set_rule(const Rule &rule) {
+    if (rule==this->rule) {
+        return;
+    }
+    this->rule = rule;
+    result_table.clear();
+}
+
+/**
+ * HashLife::advance(steps)
+ *
+ * Advance the universe by a number of generations.
+ * The steps are split into powers of two and the universe is advanced by each in turn,
+ * so a billion generations take about 30 jumps.
+ *
+ * @example
+ *
+ *      // Make a universe holding an r-pentomino
+ *      HashLife life(Zoo::r_pentomino());
+ *
+ *      // Advance it a billion generations
+ *      life.advance(1000000000);
+ *
+ * @param steps
+ *      The number of generations to advance by.
+ */
+
+void HashLife::advance(std::uint64_t steps) {
+    for (unsigned int step_level = 0; steps!=0; step_level++, steps >>= 1) {
+        if (steps & 1U) {
+            advance_power(step_level);
+        }
+    }
+    shrink();
+}
+
+/**
+ * HashLife::get_bounds(x0, y0, x1, y1)
+ *
+ * Finds the smallest rectangle holding every alive cell of the universe.
+ * The function should be callable from a constant context.
+ *
+ * Each edge is found by a search down the quadtree that remembers the answer for every node it
+ * visits, so shared nodes are searched once and the cost grows with the number of distinct nodes,
+ * not the area of the universe.
+ *
+ * @example
+ *
+ *      // Advance a universe and export exactly the area holding its alive cells
+ *      life.advance(1000);
+ *      std::int64_t x0, y0, x1, y1;
+ *      if (life.get_bounds(x0, y0, x1, y1)) {
+ *          Grid result = life.get_grid(x0, y0, x1 - x0, y1 - y0);
+ *      }
+ *
+ * @param x0
+ *      Set to the x coordinate of the leftmost alive cell, where the original grid started at 0.
+ *
+ * @param y0
+ *      Set to the y coordinate of the topmost alive cell.
+ *
+ * @param x1
+ *      Set to one past the x coordinate of the rightmost alive cell.
+ *
+ * @param y1
+ *      Set to one past the y coordinate of the bottommost alive cell.
+ *
+ * @return
+ *      True if the universe has any alive cells, false if it is empty and the bounds were not set.
+ */
+
+bool HashLife::get_bounds(std::int64_t &x0, std::int64_t &y0, std::int64_t &x1, std::int64_t &y1) const {
+    if (root->population==0) {
+        return false;
+    }
+    std::unordered_map<const Node*, std::int64_t> edges;
+    x0 = origin_x+get_edge(root, 0, edges);
+    edges.clear();
+    y0 = origin_y+get_edge(root, 1, edges);
+    edges.clear();
+    x1 = origin_x+get_edge(root, 2, edges)+1;
+    edges.clear();
+    y1 = origin_y+get_edge(root, 3, edges)+1;
+    return true;
+}
+
+/**
+ * HashLife::get_grid(x0, y0, width, height)
+ *
+ * Export a window of the universe to a grid. Cells outside the window are left out.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make a universe from a 16x16 grid
+ *      HashLife life(grid);
+ *
+ *      // Advance it and read back the same area
+ *      life.advance(100);
+ *      Grid result = life.get_grid(0, 0, 16, 16);
+ *
+ * @param x0
+ *      The x coordinate of the left edge of the window, where the original grid started at 0.
+ *
+ * @param y0
+ *      The y coordinate of the top edge of the window, where the original grid started at 0.
+ *
+ * @param width
+ *      The width of the window.
+ *
+ * @param height
+ *      The height of the window.
+ *
+ * @return
+ *      A grid of the window size holding the cells of the universe within the window.
+ */
+
+Grid HashLife::get_grid(const std::int64_t x0, const std::int64_t y0,
+                        const unsigned int width, const unsigned int height) const {
+    Grid grid(width, height);
+    draw(root, origin_x, origin_y, grid, x0, y0);
+    return grid;
+}
+
+/**
+ * HashLife::join(nw, ne, sw, se)
+ *
+ * Private helper function to get the unique node made of four quadrants, making it if it is new.
+ *
+ * @return
+ *      The node one level above the quadrants.
+ */
+
+const HashLife::Node *HashLife::join(const Node *nw, const Node *ne, const Node *sw, const Node *se) {
+    const NodeKey key{nw, ne, sw, se};
+    const auto found = node_table.find(key);
+    if (found!=node_table.end()) {
+        return found->second;
+    }
+    nodes.push_back(Node{nw, ne, sw, se, nw->level+1,
+                         nw->population+ne->population+sw->population+se->population});
+    node_table.emplace(key, &nodes.back());
+    return &nodes.back();
+}
+
+/**
+ * HashLife::get_empty(level)
+ *
+ * Private helper function to get the node of a level with no alive cells.
+ *
+ * @return
+ *      The empty node.
+ */
+
+const HashLife::Node *HashLife::get_empty(const unsigned int level) {
+    while (empty_nodes.size()<=level) {
+        const Node *empty = empty_nodes.back();
+        empty_nodes.push_back(join(empty, empty, empty, empty));
+    }
+    return empty_nodes[level];
+}
+
+/**
+ * HashLife::centre(node) / centre_horizontal(west, east) / centre_vertical(north, south)
+ *
+ * Private helper functions to get the node of one level down in the middle of a node,
+ * straddling two side by side nodes, or straddling two stacked nodes.
+ */
+
+const HashLife::Node *HashLife::centre(const Node *node) {
+    return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+const HashLife::Node *HashLife::centre_horizontal(const Node *west, const Node *east) {
+    return join(west->ne, east->nw, west->se, east->sw);
+}
+
+const HashLife::Node *HashLife::centre_vertical(const Node *north, const Node *south) {
+    return join(north->sw, north->se, south->nw, south->ne);
+}
+
+/**
+ * HashLife::step_base(node)
+ *
+ * Private helper function to step the centre 2x2 cells of a 4x4 level 2 node by one generation,
+ * applying the rule of the universe directly.
+ *
+ * @return
+ *      The level 1 node holding the next generation of the centre.
+ */
+
+const HashLife::Node *HashLife::step_base(const Node *node) {
+    //unpack the 16 cells into bit (y * 4 + x)
+    const Node *quadrants[4] = {node->nw, node->ne, node->sw, node->se};
+    unsigned int cells = 0;
+    for (unsigned int y = 0; y < 4; y++) {
+        for (unsigned int x = 0; x < 4; x++) {
+            const Node *quadrant = quadrants[(y/2)*2+(x/2)];
+            const Node *cells_in_quadrant[4] = {quadrant->nw, quadrant->ne, quadrant->sw, quadrant->se};
+            if (cells_in_quadrant[(y%2)*2+(x%2)]->population) {
+                cells |= 1U << (y*4+x);
+            }
+        }
+    }
+    //count the neighbours of each of the centre cells and apply the rules
+    const Node *next[4];
+    for (unsigned int y = 1; y <= 2; y++) {
+        for (unsigned int x = 1; x <= 2; x++) {
+            unsigned int num_neighbours = 0;
+            for (unsigned int row = y-1; row <= y+1; row++) {
+                for (unsigned int column = x-1; column <= x+1; column++) {
+                    if (!(row==y && column==x) && ((cells >> (row*4+column)) & 1U)) {
+                        num_neighbours++;
+                    }
+                }
+            }
+            const bool alive = (cells >> (y*4+x)) & 1U;
+            const Cell cell = rule.get_next(alive ? Cell::ALIVE : Cell::DEAD, num_neighbours);
+            next[(y-1)*2+(x-1)] = (cell==Cell::ALIVE) ? alive_cell : dead_cell;
+        }
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+/**
+ * HashLife::successor(node, step_level)
+ *
+ * Private helper function to compute the centre of a node 2^j generations ahead, where j is step_level
+ * limited to at most the level of the node minus 2. Results are memoized for every node and j.
+ *
+ * The node is covered by 9 overlapping sub-squares of one level down. Each is advanced recursively,
+ * giving 9 centres that tile the middle of the node. For the largest j these are regrouped into 4 squares
+ * and advanced again, taking two half sized jumps in time. For smaller j the 9 centres are only advanced
+ * once, and the 4 squares are cropped to their centres instead.
+ *
+ * @return
+ *      The node of one level down holding the advanced centre.
+ */
+
+const HashLife::Node *HashLife::successor(const Node *node, const unsigned int step_level) {
+    if (node->population==0) {
+        return get_empty(node->level-1);
+    }
+    const unsigned int j = (step_level<node->level-2) ? step_level : node->level-2;
+    const ResultKey key{node, j};
+    const auto found = result_table.find(key);
+    if (found!=result_table.end()) {
+        return found->second;
+    }
+
+    const Node *result;
+    if (node->level==2) {
+        result = step_base(node);
+    } else {
+        //the 9 overlapping sub-squares, by row then column
+        const Node *n00 = node->nw, *n01 = centre_horizontal(node->nw, node->ne), *n02 = node->ne;
+        const Node *n10 = centre_vertical(node->nw, node->sw), *n11 = centre(node);
+        const Node *n12 = centre_vertical(node->ne, node->se);
+        const Node *n20 = node->sw, *n21 = centre_horizontal(node->sw, node->se), *n22 = node->se;
+        const Node *c00 = successor(n00, j), *c01 = successor(n01, j), *c02 = successor(n02, j);
+        const Node *c10 = successor(n10, j), *c11 = successor(n11, j), *c12 = successor(n12, j);
+        const Node *c20 = successor(n20, j), *c21 = successor(n21, j), *c22 = successor(n22, j);
+        if (j==node->level-2) {
+            //the first half of the jump was taken above, take the second half on the 4 squares
+            result = join(successor(join(c00, c01, c10, c11), j), successor(join(c01, c02, c11, c12), j),
+                          successor(join(c10, c11, c20, c21), j), successor(join(c11, c12, c21, c22), j));
+        } else {
+            //the whole jump was taken above, crop the 4 squares to their centres
+            result = join(centre(join(c00, c01, c10, c11)), centre(join(c01, c02, c11, c12)),
+                          centre(join(c10, c11, c20, c21)), centre(join(c11, c12, c21, c22)));
+        }
+    }
+    result_table.emplace(key, result);
+    return result;
+}
+
+/**
+ * HashLife::build(grid, x, y, level)
+ *
+ * Private helper function to make the node for the square of a grid with its top left corner at x,y.
+ * Parts of the square outside the grid are dead.
+ *
+ * @return
+ *      The node holding the square.
+ */
+
+const HashLife::Node *HashLife::build(const Grid &grid, const unsigned int x, const unsigned int y,
+                                      const unsigned int level) {
+    if (x>=grid.get_width() || y>=grid.get_height()) {
+        return get_empty(level);
+    }
+    if (level==0) {
+        return (grid.get_unchecked(x, y)==Cell::ALIVE) ? alive_cell : dead_cell;
+    }
+    //a 64x64 square is a single word in each of its rows, so empty space is skipped a word at a time
+    if (level==6) {
+        bool empty = true;
+        for (unsigned int row = y; row < y+64 && row < grid.get_height() && empty; row++) {
+            empty = (grid.get_row_unchecked(row)[x/Grid::BITS_PER_WORD]==0);
+        }
+        if (empty) {
+            return get_empty(level);
+        }
+    }
+    const unsigned int half = 1U << (level-1);
+    return join(build(grid, x, y, level-1), build(grid, x+half, y, level-1),
+                build(grid, x, y+half, level-1), build(grid, x+half, y+half, level-1));
+}
+
+/**
+ * HashLife::draw(node, x, y, grid, x0, y0)
+ *
+ * Private helper function to write the alive cells of a node with its top left corner at x,y
+ * into a grid whose top left corner is at x0,y0. Empty nodes and nodes outside the grid are skipped.
+ */
+
+void HashLife::draw(const Node *node, const std::int64_t x, const std::int64_t y, Grid &grid,
+                    const std::int64_t x0, const std::int64_t y0) const {
+    const std::int64_t size = std::int64_t(1) << node->level;
+    if (node->population==0 || x+size<=x0 || y+size<=y0
+        || x>=x0+(std::int64_t) grid.get_width() || y>=y0+(std::int64_t) grid.get_height()) {
+        return;
+    }
+    if (node->level==0) {
+        grid.set_unchecked(x-x0, y-y0, Cell::ALIVE);
+        return;
+    }
+    const std::int64_t half = size/2;
+    draw(node->nw, x, y, grid, x0, y0);
+    draw(node->ne, x+half, y, grid, x0, y0);
+    draw(node->sw, x, y+half, grid, x0, y0);
+    draw(node->se, x+half, y+half, grid, x0, y0);
+}
+
+/**
+ * HashLife::get_edge(node, side, edges)
+ *
+ * Private helper function to find the outermost alive cell of a node that is not empty, on one side,
+ * relative to the top left corner of the node. Sides 0 and 1 are the smallest x and y, sides 2 and 3
+ * are the largest x and y. Results are remembered in edges, which must only hold results for the side.
+ *
+ * @return
+ *      The coordinate of the outermost alive cell on the side.
+ */
+
+std::int64_t HashLife::get_edge(const Node *node, const unsigned int side,
+                                std::unordered_map<const Node*, std::int64_t> &edges) const {
+    if (node->level==0) {
+        return 0;
+    }
+    const auto found = edges.find(node);
+    if (found!=edges.end()) {
+        return found->second;
+    }
+    // the near pair of quadrants is searched first, the far pair only if the near pair is empty
+    const bool vertical = side%2==1;
+    const bool largest = side>=2;
+    const Node *low_a = node->nw;
+    const Node *low_b = vertical ? node->ne : node->sw;
+    const Node *high_a = vertical ? node->sw : node->ne;
+    const Node *high_b = node->se;
+    const Node *near_a = largest ? high_a : low_a;
+    const Node *near_b = largest ? high_b : low_b;
+    bool high = largest;
+    if (near_a->population==0 && near_b->population==0) {
+        near_a = largest ? low_a : high_a;
+        near_b = largest ? low_b : high_b;
+        high = !largest;
+    }
+    const std::int64_t offset = high ? std::int64_t(1) << (node->level-1) : 0;
+    std::int64_t edge;
+    if (near_a->population==0) {
+        edge = get_edge(near_b, side, edges);
+    } else if (near_b->population==0) {
+        edge = get_edge(near_a, side, edges);
+    } else {
+        const std::int64_t a = get_edge(near_a, side, edges);
+        const std::int64_t b = get_edge(near_b, side, edges);
+        edge = largest ? std::max(a, b) : std::min(a, b);
+    }
+    edge += offset;
+    edges.emplace(node, edge);
+    return edge;
+}
+
+/**
+ * HashLife::is_padded(node)
+ *
+ * Private helper function to check that every alive cell of a node is within its centre square.
+ *
+ * @return
+ *      True if the border around the centre square is empty.
+ */
+
+bool HashLife::is_padded(const Node *node) const {
+    return node->population==node->nw->se->population+node->ne->sw->population
+                             +node->sw->ne->population+node->se->nw->population;
+}
+
+/**
+ * HashLife::expand()
+ *
+ * Private helper function to double the size of the universe, keeping the old root in the centre
+ * surrounded by empty space.
+ */
+
+void HashLife::expand() {
+    const Node *empty = get_empty(root->level-1);
+    origin_x -= std::int64_t(1) << (root->level-1);
+    origin_y -= std::int64_t(1) << (root->level-1);
+    root = join(join(empty, empty, empty, root->nw), join(empty, empty, root->ne, empty),
+                join(empty, root->sw, empty, empty), join(root->se, empty, empty, empty));
+}
+
+/**
+ * HashLife::shrink()
+ *
+ * Private helper function to halve the size of the universe while the border around the centre is empty,
+ * keeping it no larger than it needs to be.
+ */
+
+void HashLife::shrink() {
+    while (root->level>3 && is_padded(root)) {
+        origin_x += std::int64_t(1) << (root->level-2);
+        origin_y += std::int64_t(1) << (root->level-2);
+        root = centre(root);
+    }
+}
+
+/**
+ * HashLife::advance_power(step_level)
+ *
+ * Private helper function to advance the universe by 2^step_level generations.
+ *
+ * The universe is first grown until it is large enough to take the jump and every alive cell is in its
+ * centre, then grown once more so the pattern has 2^step_level cells of empty space to expand into
+ * without leaving the centre square that HashLife::successor returns.
+ */
+
+void HashLife::advance_power(const unsigned int step_level) {
+    while (root->level<step_level+2 || !is_padded(root)) {
+        expand();
+    }
+    expand();
+    origin_x += std::int64_t(1) << (root->level-2);
+    origin_y += std::int64_t(1) << (root->level-2);
+    root = successor(root, step_level);
+    generation += std::uint64_t(1) << step_level;
+}
@@ -0,0 +1,95 @@
+/**
+ * Declares a class representing an unbounded Game of Life universe stored as a hash-consed quadtree.
+ * Rich documentation for the api and behaviour the HashLife class can be found in hashlife.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the class.
+// #include ...
+#include "grid.h"
+#include "rule.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+/**
+ * Declare the structure of the HashLife class for advancing a universe by huge numbers of generations.
+ */
+class HashLife {
+    private:
+        /**
+         * A square of 2^level by 2^level cells, made of four quadrants of the level below.
+         * Level 0 nodes are single cells and have no quadrants.
+         */
+        struct Node {
+            const Node *nw;
+            const Node *ne;
+            const Node *sw;
+            const Node *se;
+            unsigned int level;
+            std::uint64_t population;
+        };
+        struct NodeKey {
+            const Node *nw, *ne, *sw, *se;
+            bool operator==(const NodeKey &other) const;
+        };
+        struct NodeKeyHash {
+            std::size_t operator()(const NodeKey &key) const;
+        };
+        struct ResultKey {
+            const Node *node;
+            unsigned int step_level;
+            bool operator==(const ResultKey &other) const;
+        };
+        struct ResultKeyHash {
+            std::size_t operator()(const ResultKey &key) const;
+        };
+
+        std::deque<Node> nodes;
+        std::unordered_map<NodeKey, const Node*, NodeKeyHash> node_table;
+        std::unordered_map<ResultKey, const Node*, ResultKeyHash> result_table;
+        std::vector<const Node*> empty_nodes;
+        const Node *dead_cell;
+        const Node *alive_cell;
+        const Node *root;
+        std::int64_t origin_x;
+        std::int64_t origin_y;
+        std::uint64_t generation;
+        Rule rule;
+
+        const Node *join(const Node *nw, const Node *ne, const Node *sw, const Node *se);
+        const Node *get_empty(const unsigned int level);
+        const Node *centre(const Node *node);
+        const Node *centre_horizontal(const Node *west, const Node *east);
+        const Node *centre_vertical(const Node *north, const Node *south);
+        const Node *step_base(const Node *node);
+        const Node *successor(const Node *node, const unsigned int step_level);
+        const Node *build(const Grid &grid, const unsigned int x, const unsigned int y, const unsigned int level);
+        void draw(const Node *node, const std::int64_t x, const std::int64_t y, Grid &grid,
+                  const std::int64_t x0, const std::int64_t y0) const;
+        std::int64_t get_edge(const Node *node, const unsigned int side,
+                              std::unordered_map<const Node*, std::int64_t> &edges) const;
+        bool is_padded(const Node *node) const;
+        void expand();
+        void shrink();
+        void advance_power(const unsigned int step_level);
+    public:
+        HashLife();
+        explicit HashLife(const Grid &grid);
+        HashLife(const HashLife &other) = delete;
+        HashLife &operator=(const HashLife &other) = delete;
+
+        std::uint64_t get_population() const;
+        std::uint64_t get_generation() const;
+        std::size_t get_num_nodes() const;
+        const Rule &get_rule() const;
+        void set_rule(const Rule &rule);
+        bool get_bounds(std::int64_t &x0, std::int64_t &y0, std::int64_t &x1, std::int64_t &y1) const;
+        void advance(std::uint64_t steps);
+        Grid get_grid(const std::int64_t x0, const std::int64_t y0,
+                      const unsigned int width, const unsigned int height) const;
+};
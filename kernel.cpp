@@ -0,0 +1,827 @@
+/**
+ * Implements a Kernel namespace with word level functions for stepping bit-packed rows of a Grid.
+ *      - Each 64 bit word of a row holds 64 cells, see Grid::get_row(y).
+ *      - The 8 neighbours of every cell in a word are summed in parallel with bitwise full adders,
+ *        giving the neighbour count of all 64 cells as 4 bit-sliced words.
+ *      - The rule is then applied to the whole word with bitwise logic, so there is no per-cell branching
+ *        or bounds checking. See rule.cpp.
+ *          - The kernels are templates over the rule. Conway's Game of Life, HighLife, Day & Night and Seeds
+ *            are compiled in as fixed rules, so the tests of the rule fold away into the same inner loop
+ *            a hard coded rule would have. Kernel::step_row picks the instantiation from the rule it is given.
+ *          - Any other rule is applied from its masks at runtime, which is correct but slower.
+ *
+ *      - Neighbours in the row to the left and right of a word are found by shifting the word
+ *        by one bit and carrying in the edge bit of the adjacent word.
+ *          - At the ends of a row the carried in bit is the cell at the opposite end of the row if the
+ *            left and right edges wrap, the cell at the end itself if they reflect, otherwise Cell::DEAD.
+ *            These are found once for each row, so the loops over the words never test the topology.
+ *          - The rows above and below are chosen by the caller, so the same kernel serves every topology.
+ *          - Any run of words within a row can be stepped on its own, so callers can skip inactive regions.
+ *
+ *      - The adder logic is written once as a template over the word type, and instantiated for
+ *          - Kernel::Type::SCALAR, a plain 64 bit word (64 cells per operation).
+ *          - Kernel::Type::SSE2, a 128 bit vector (128 cells per operation).
+ *          - Kernel::Type::AVX2, a 256 bit vector (256 cells per operation).
+ *          - Kernel::Type::AVX512, a 512 bit vector (512 cells per operation).
+ *        The vector types use GCC vector extensions, and each vector instantiation is compiled for its
+ *        instruction set with a target attribute, so no special compiler flags are needed.
+ *          - Kernel::best() picks the widest instruction set the running CPU supports.
+ *
+ *      - Kernel::Type::LOOKUP steps rows without any neighbour arithmetic, for machines without wide vectors.
+ *          - A table of 65536 entries holds the next generation of the centre 2x2 cells of every 4x4 block
+ *            of cells, with the block packed into the 16 bits of its index. It is built at compile time for
+ *            the fixed rules, and once at runtime for any other rule.
+ *          - Kernel::get_lookup_table finds the table of a rule. Callers find it once, as when the rule is set,
+ *            and hand it to every Kernel::step_row, so stepping a row never takes a lock or searches for it.
+ *          - Kernel::step_row_pair steps two rows at once. The 4 columns around each pair of cells in the row
+ *            above, both rows, and the row below are packed into an index, and the two halves of the entry are
+ *            the next pairs of both rows, so each lookup gives 4 cells and each word of a row takes 16 lookups.
+ *          - Kernel::step_row steps a row left without a pair with a dead fourth row, using only the top half
+ *            of each entry.
+ *          - Kernel::Type::REFERENCE is stepped cell by cell by World using World::count_neighbours.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "kernel.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include "rule.h"
+#include "topology.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNEL_X86_VECTORS
+//vectors are only passed between always_inline helpers inside one target function, never across a real call
+#pragma GCC diagnostic ignored "-Wpsabi"
+typedef std::uint64_t u64x2 __attribute__((vector_size(16)));
+typedef std::uint64_t u64x4 __attribute__((vector_size(32)));
+typedef std::uint64_t u64x8 __attribute__((vector_size(64)));
+#endif
+
+/**
+ * FixedRule<BIRTH, SURVIVAL>
+ *
+ * Helper rule known at compile time, with the same masks as Rule::get_birth() and Rule::get_survival().
+ */
+
+template <std::uint16_t BIRTH, std::uint16_t SURVIVAL>
+struct FixedRule {
+    constexpr std::uint16_t get_birth() const {
+        return BIRTH;
+    }
+
+    constexpr std::uint16_t get_survival() const {
+        return SURVIVAL;
+    }
+
+    static bool matches(const Rule &rule) {
+        return rule.get_birth()==BIRTH && rule.get_survival()==SURVIVAL;
+    }
+};
+
+typedef FixedRule<1U << 3, (1U << 2) | (1U << 3)> ConwayRule;
+typedef FixedRule<(1U << 3) | (1U << 6), (1U << 2) | (1U << 3)> HighLifeRule;
+typedef FixedRule<(1U << 3) | (1U << 6) | (1U << 7) | (1U << 8),
+                  (1U << 3) | (1U << 4) | (1U << 6) | (1U << 7) | (1U << 8)> DayAndNightRule;
+typedef FixedRule<1U << 2, 0> SeedsRule;
+
+/**
+ * RuntimeRule
+ *
+ * Helper rule only known at runtime, copied out of a Rule so its masks can be read without a call.
+ */
+
+struct RuntimeRule {
+    std::uint16_t birth;
+    std::uint16_t survival;
+
+    std::uint16_t get_birth() const {
+        return birth;
+    }
+
+    std::uint16_t get_survival() const {
+        return survival;
+    }
+};
+
+/**
+ * get_bit(row, x)
+ *
+ * Helper to read the cell in column x of a row as a 0 or 1 bit.
+ */
+
+static std::uint64_t get_bit(const std::uint64_t *row, const unsigned int x) {
+    return (row[x/64] >> (x%64)) & 1U;
+}
+
+/**
+ * get_ends(row, width, topology)
+ *
+ * Helper to find the cells just past the start and the end of a row, wrapped from the opposite end if the
+ * left and right edges wrap, the cells on the ends themselves if they reflect, otherwise Cell::DEAD.
+ * Bit 0 of the result is the cell past the start and bit 1 the cell past the end. The bits are passed
+ * on in a register rather than in memory, as the vector kernels stall reading a freshly written struct.
+ */
+
+static unsigned int get_ends(const std::uint64_t *row, const unsigned int width, const Topology::Type topology) {
+    if (width==0) {
+        return 0;
+    }
+    if (Topology::wraps_x(topology)) {
+        return get_bit(row, width-1) | (get_bit(row, 0) << 1);
+    }
+    if (topology==Topology::Type::REFLECT) {
+        return get_bit(row, 0) | (get_bit(row, width-1) << 1);
+    }
+    return 0;
+}
+
+/**
+ * shift_row(row, i, num_words, width, ends, west, east)
+ *
+ * Helper to build the words holding the west (x-1) and east (x+1) neighbours of each cell in word i of a row.
+ * Bit k of west is the cell to the left of bit k of row[i], and bit k of east is the cell to its right.
+ */
+
+static void shift_row(const std::uint64_t *row, const unsigned int i, const unsigned int num_words,
+                      const unsigned int width, const unsigned int ends, std::uint64_t &west, std::uint64_t &east) {
+    //the cell left of bit 0 is the top bit of the previous word, or the cell carried in at the start of the row
+    const std::uint64_t carry_west = (i>0) ? (row[i-1] >> 63) : (ends & 1U);
+    west = (row[i] << 1) | carry_west;
+    //the cell right of bit 63 is the bottom bit of the next word, the last word of a row instead
+    //carries in the cell past the end of the row at the position just past the last column
+    if (i+1<num_words) {
+        east = (row[i] >> 1) | (row[i+1] << 63);
+    } else {
+        east = (row[i] >> 1) | ((std::uint64_t) ((ends >> 1) & 1U) << ((width-1)%64));
+    }
+}
+
+/**
+ * apply_rule(rule, count0, count1, count2, count3, row)
+ *
+ * Helper to apply a rule to every cell held in a word (or vector of words) given its bit-sliced neighbour
+ * counts. Each count the rule births or keeps alive at is matched against all four slices, and the cells
+ * matching any of them are alive. With a FixedRule the loop unrolls and the untaken counts disappear.
+ */
+
+template <typename Word, typename RuleType>
+__attribute__((always_inline)) static inline Word apply_rule(const RuleType rule,
+        const Word count0, const Word count1, const Word count2, const Word count3, const Word row) {
+    Word next = row ^ row;
+#pragma GCC unroll 9
+    for (unsigned int count = 0; count <= 8; count++) {
+        const bool birth = (rule.get_birth() >> count) & 1U;
+        const bool survival = (rule.get_survival() >> count) & 1U;
+        if (!birth && !survival) {
+            continue;
+        }
+        const Word match = ((count & 1U) ? count0 : ~count0) & ((count & 2U) ? count1 : ~count1)
+                           & ((count & 4U) ? count2 : ~count2) & ((count & 8U) ? count3 : ~count3);
+        if (birth && survival) {
+            next |= match;
+        } else if (birth) {
+            next |= match & ~row;
+        } else {
+            next |= match & row;
+        }
+    }
+    return next;
+}
+
+/**
+ * next_generation(rule, above_west, above, above_east, west, row, east, below_west, below, below_east)
+ *
+ * Helper to compute the next generation of every cell held in a word (or vector of words) given the
+ * words holding each of its 8 neighbours, and the word holding the cells themselves.
+ *
+ * The neighbour count of every cell is accumulated with bitwise adders into the bit-sliced words
+ * count0 (1s), count1 (2s), count2 (4s), and count3 (8s), such that the count for the cell in bit k
+ * is the number formed by bit k of each of the four words.
+ *      - The above and below rows contribute 3 neighbours each, summed by a full adder into a 2 bit number.
+ *      - The row itself contributes 2 neighbours, summed by a half adder.
+ *      - The three partial sums are then added together.
+ *
+ * The rule is then applied to the counts by apply_rule.
+ */
+
+template <typename Word, typename RuleType>
+__attribute__((always_inline)) static inline Word next_generation(const RuleType rule,
+        const Word above_west, const Word above, const Word above_east,
+        const Word west, const Word row, const Word east,
+        const Word below_west, const Word below, const Word below_east) {
+    //full adder over the 3 cells above gives a 2 bit sum (above1, above0)
+    const Word above_half = above_west ^ above;
+    const Word above0 = above_half ^ above_east;
+    const Word above1 = (above_west & above) | (above_half & above_east);
+    //full adder over the 3 cells below gives a 2 bit sum (below1, below0)
+    const Word below_half = below_west ^ below;
+    const Word below0 = below_half ^ below_east;
+    const Word below1 = (below_west & below) | (below_half & below_east);
+    //half adder over the 2 cells beside gives a 2 bit sum (middle1, middle0)
+    const Word middle0 = west ^ east;
+    const Word middle1 = west & east;
+
+    //add the 1s columns, carrying into the 2s column
+    const Word ones_half = above0 ^ below0;
+    const Word count0 = ones_half ^ middle0;
+    const Word carry1 = (above0 & below0) | (ones_half & middle0);
+    //add the four 2s bits, carrying into the 4s column
+    const Word twos_a = above1 ^ below1;
+    const Word twos_b = middle1 ^ carry1;
+    const Word count1 = twos_a ^ twos_b;
+    const Word carry2_a = above1 & below1;
+    const Word carry2_b = middle1 & carry1;
+    const Word carry2_c = twos_a & twos_b;
+    //add the three 4s carries, carrying into the 8s column
+    const Word count2 = carry2_a ^ carry2_b ^ carry2_c;
+    const Word count3 = (carry2_a & carry2_b) | (carry2_c & (carry2_a ^ carry2_b));
+
+    return apply_rule(rule, count0, count1, count2, count3, row);
+}
+
+/**
+ * step_edge_word(rule, above, row, below, out, i, num_words, width, ends)
+ *
+ * Helper to compute word i of a row one word at a time, handling the carries in from the ends of
+ * the row and clearing the padding bits of the last word.
+ */
+
+template <typename RuleType>
+static void step_edge_word(const RuleType rule, const std::uint64_t *above, const std::uint64_t *row,
+                           const std::uint64_t *below, std::uint64_t *out, const unsigned int i,
+                           const unsigned int num_words, const unsigned int width, const unsigned int ends) {
+    std::uint64_t above_west, above_east, west, east, below_west, below_east;
+    shift_row(above, i, num_words, width, ends, above_west, above_east);
+    shift_row(row, i, num_words, width, ends >> 2, west, east);
+    shift_row(below, i, num_words, width, ends >> 4, below_west, below_east);
+    std::uint64_t next = next_generation(rule, above_west, above[i], above_east, west, row[i], east,
+                                         below_west, below[i], below_east);
+    //keep the padding bits past the width dead
+    if (i+1==num_words && width%64!=0) {
+        next &= (std::uint64_t(1) << (width%64))-1;
+    }
+    out[i] = next;
+}
+
+/**
+ * load(words)
+ *
+ * Helper to read a word, or vector of consecutive words, from a possibly unaligned address.
+ */
+
+template <typename Word>
+__attribute__((always_inline)) static inline Word load(const std::uint64_t *words) {
+    Word value;
+    __builtin_memcpy(&value, words, sizeof(Word));
+    return value;
+}
+
+/**
+ * store(words, value)
+ *
+ * Helper to write a word, or vector of consecutive words, to a possibly unaligned address.
+ */
+
+template <typename Word>
+__attribute__((always_inline)) static inline void store(std::uint64_t *words, const Word value) {
+    __builtin_memcpy(words, &value, sizeof(Word));
+}
+
+/**
+ * step_words(rule, above, row, below, out, first_word, last_word, num_words, width, ends)
+ *
+ * Helper to step the words [first_word, last_word) of a row, (sizeof(Word) / 8) words at a time.
+ *
+ * The interior words of a row have a word on either side, so the west and east neighbours are found
+ * by loading the same run of words offset by one word in each direction, shifting, and combining.
+ * The first and last words of the row, and any words left over, are done by step_edge_word.
+ */
+
+template <typename Word, typename RuleType>
+__attribute__((always_inline)) static inline void step_words(const RuleType rule,
+        const std::uint64_t *above, const std::uint64_t *row, const std::uint64_t *below, std::uint64_t *out,
+        const unsigned int first_word, const unsigned int last_word, const unsigned int num_words,
+        const unsigned int width, const unsigned int ends) {
+    const unsigned int lanes = sizeof(Word)/sizeof(std::uint64_t);
+    unsigned int i = first_word;
+    if (i==0 && i<last_word) {
+        step_edge_word(rule, above, row, below, out, 0, num_words, width, ends);
+        i++;
+    }
+    //vectors of interior words, word i+lanes-1 must be before the last word of the row
+    for (; i+lanes<=last_word && i+lanes<num_words; i+=lanes) {
+        const Word above_word = load<Word>(above+i);
+        const Word row_word = load<Word>(row+i);
+        const Word below_word = load<Word>(below+i);
+        const Word above_west = (above_word << 1) | (load<Word>(above+i-1) >> 63);
+        const Word above_east = (above_word >> 1) | (load<Word>(above+i+1) << 63);
+        const Word west = (row_word << 1) | (load<Word>(row+i-1) >> 63);
+        const Word east = (row_word >> 1) | (load<Word>(row+i+1) << 63);
+        const Word below_west = (below_word << 1) | (load<Word>(below+i-1) >> 63);
+        const Word below_east = (below_word >> 1) | (load<Word>(below+i+1) << 63);
+        store<Word>(out+i, next_generation(rule, above_west, above_word, above_east, west, row_word, east,
+                                           below_west, below_word, below_east));
+    }
+    //remaining interior words and the last word
+    for (; i<last_word; i++) {
+        step_edge_word(rule, above, row, below, out, i, num_words, width, ends);
+    }
+}
+
+/**
+ * Kernel::LookupTable
+ *
+ * The table of the next generation under a rule of the centre 2x2 cells of every 4x4 block of cells.
+ * Bit 4*y+x of an index is the cell in row y and column x of the block, and bits 0, 1, 2 and 3 of an entry
+ * are the next cells at (1, 1), (2, 1), (1, 2) and (2, 2).
+ */
+
+struct Kernel::LookupTable {
+    unsigned char next[65536];
+
+    constexpr LookupTable(const std::uint16_t birth, const std::uint16_t survival): next() {
+        //the next centre cell of every 3x3 block, bit 3*y+x of an index is the cell in row y and column x
+        unsigned char centre[512] = {};
+        for (unsigned int block = 0; block < 512; block++) {
+            centre[block] = ((((block & 16U) ? survival : birth) >> __builtin_popcount(block & ~16U)) & 1U);
+        }
+        //the next pair of cells in the middle row of every 3x4 block, bit 4*y+x of an index is the cell in row y
+        //and column x, the 3x3 block around each cell being 3 bits from each of the 3 rows
+        unsigned char pair[4096] = {};
+        for (unsigned int block = 0; block < 4096; block++) {
+            const unsigned int right = block >> 1;
+            pair[block] = centre[(block & 7U) | ((block >> 1) & 0x38U) | ((block >> 2) & 0x1C0U)]
+                          | (centre[(right & 7U) | ((right >> 1) & 0x38U) | ((right >> 2) & 0x1C0U)] << 1);
+        }
+        //the top pair of a 4x4 block is the pair of its first 3 rows, the bottom pair that of its last 3 rows,
+        //so each entry takes 2 lookups, which keeps the table well within the limits of compile time evaluation
+        for (unsigned int block = 0; block < 65536; block++) {
+            next[block] = pair[block & 0xFFFU] | (pair[block >> 4] << 2);
+        }
+    }
+};
+
+template <typename RuleType>
+static constexpr Kernel::LookupTable LOOKUP_TABLE{RuleType().get_birth(), RuleType().get_survival()};
+
+/**
+ * get_window(row, i, num_words, width, ends, window, last)
+ *
+ * Helper to gather the cells around word i of a row for the lookup table. Bit j of window is the cell in
+ * column 64*i+j-1, and the low 4 bits of last are the cells in columns 64*i+61 to 64*i+64, which do not fit.
+ * Cells past the ends of the row are the cells carried in by ends.
+ */
+
+static void get_window(const std::uint64_t *row, const unsigned int i, const unsigned int num_words,
+                       const unsigned int width, const unsigned int ends, std::uint64_t &window, std::uint64_t &last) {
+    std::uint64_t word = row[i];
+    std::uint64_t east = 0;
+    if (i+1<num_words) {
+        east = row[i+1] & 1U;
+    } else {
+        //the cell past the end goes just past the last column, in the padding or in the next word
+        if (width%64!=0) {
+            word |= (std::uint64_t) ((ends >> 1) & 1U) << (width%64);
+        } else {
+            east = (ends >> 1) & 1U;
+        }
+    }
+    const std::uint64_t west = (i>0) ? (row[i-1] >> 63) : (ends & 1U);
+    window = (word << 1) | west;
+    last = (word >> 61) | (east << 3);
+}
+
+/**
+ * step_row_lookup(table, above, row, below, out, first_word, last_word, num_words, width, ends)
+ *
+ * Helper to step the words [first_word, last_word) of a single row two cells at a time with the lookup table of a
+ * rule, for a row left without a pair.
+ */
+
+static void step_row_lookup(const Kernel::LookupTable &table, const std::uint64_t *above, const std::uint64_t *row,
+                            const std::uint64_t *below, std::uint64_t *out, const unsigned int first_word,
+                            const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                            const unsigned int ends) {
+    for (unsigned int i = first_word; i < last_word; i++) {
+        std::uint64_t above_window, above_last, window, last, below_window, below_last;
+        get_window(above, i, num_words, width, ends, above_window, above_last);
+        get_window(row, i, num_words, width, ends >> 2, window, last);
+        get_window(below, i, num_words, width, ends >> 4, below_window, below_last);
+        std::uint64_t next = 0;
+        //the columns either side of the pair of cells at bits k and k+1 are bits k to k+3 of the windows
+        for (unsigned int k = 0; k < 62; k += 2) {
+            const unsigned int index = ((above_window >> k) & 0xF) | (((window >> k) & 0xF) << 4)
+                                       | (((below_window >> k) & 0xF) << 8);
+            next |= std::uint64_t(table.next[index] & 3U) << k;
+        }
+        const unsigned int index = above_last | (last << 4) | (below_last << 8);
+        next |= std::uint64_t(table.next[index] & 3U) << 62;
+        //keep the padding bits past the width dead
+        if (i+1==num_words && width%64!=0) {
+            next &= (std::uint64_t(1) << (width%64))-1;
+        }
+        out[i] = next;
+    }
+}
+
+/**
+ * step_row_pair_lookup(table, above, first, second, below, first_out, second_out, first_word, last_word,
+ *                      num_words, width, ends)
+ *
+ * Helper to step the words [first_word, last_word) of two neighbouring rows four cells at a time with the
+ * lookup table of a rule, each 4x4 block spanning the row above, both rows, and the row below.
+ */
+
+static void step_row_pair_lookup(const Kernel::LookupTable &table, const std::uint64_t *above,
+                                 const std::uint64_t *first, const std::uint64_t *second, const std::uint64_t *below,
+                                 std::uint64_t *first_out, std::uint64_t *second_out, const unsigned int first_word,
+                                 const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                                 const unsigned int ends) {
+    for (unsigned int i = first_word; i < last_word; i++) {
+        std::uint64_t above_window, above_last, first_window, first_last;
+        std::uint64_t second_window, second_last, below_window, below_last;
+        get_window(above, i, num_words, width, ends, above_window, above_last);
+        get_window(first, i, num_words, width, ends >> 2, first_window, first_last);
+        get_window(second, i, num_words, width, ends >> 4, second_window, second_last);
+        get_window(below, i, num_words, width, ends >> 6, below_window, below_last);
+        std::uint64_t next_first = 0, next_second = 0;
+        //bits 0 and 1 of an entry are the next pair of the first row, bits 2 and 3 of the second
+        for (unsigned int k = 0; k < 62; k += 2) {
+            const unsigned int index = ((above_window >> k) & 0xF) | (((first_window >> k) & 0xF) << 4)
+                                       | (((second_window >> k) & 0xF) << 8) | (((below_window >> k) & 0xF) << 12);
+            const std::uint64_t next = table.next[index];
+            next_first |= (next & 3U) << k;
+            next_second |= (next >> 2) << k;
+        }
+        const std::uint64_t next = table.next[above_last | (first_last << 4) | (second_last << 8) | (below_last << 12)];
+        next_first |= (next & 3U) << 62;
+        next_second |= (next >> 2) << 62;
+        //keep the padding bits past the width dead
+        if (i+1==num_words && width%64!=0) {
+            next_first &= (std::uint64_t(1) << (width%64))-1;
+            next_second &= (std::uint64_t(1) << (width%64))-1;
+        }
+        first_out[i] = next_first;
+        second_out[i] = next_second;
+    }
+}
+
+/**
+ * step_row_scalar / step_row_sse2 / step_row_avx2 / step_row_avx512
+ *
+ * Helpers instantiating step_words for each word width and rule, compiled for the matching instruction set.
+ */
+
+template <typename RuleType>
+static void step_row_scalar(const RuleType rule, const std::uint64_t *above, const std::uint64_t *row,
+                            const std::uint64_t *below, std::uint64_t *out, const unsigned int first_word,
+                            const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                            const unsigned int ends) {
+    step_words<std::uint64_t>(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+}
+
+#ifdef KERNEL_X86_VECTORS
+template <typename RuleType>
+__attribute__((target("sse2")))
+static void step_row_sse2(const RuleType rule, const std::uint64_t *above, const std::uint64_t *row,
+                          const std::uint64_t *below, std::uint64_t *out, const unsigned int first_word,
+                          const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                          const unsigned int ends) {
+    step_words<u64x2>(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+}
+
+template <typename RuleType>
+__attribute__((target("avx2")))
+static void step_row_avx2(const RuleType rule, const std::uint64_t *above, const std::uint64_t *row,
+                          const std::uint64_t *below, std::uint64_t *out, const unsigned int first_word,
+                          const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                          const unsigned int ends) {
+    step_words<u64x4>(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+}
+
+template <typename RuleType>
+__attribute__((target("avx512f")))
+static void step_row_avx512(const RuleType rule, const std::uint64_t *above, const std::uint64_t *row,
+                            const std::uint64_t *below, std::uint64_t *out, const unsigned int first_word,
+                            const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                            const unsigned int ends) {
+    step_words<u64x8>(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+}
+#endif
+
+/**
+ * step_rule(type, rule, above, row, below, out, first_word, last_word, num_words, width, ends)
+ *
+ * Helper to step the words [first_word, last_word) of a row with the kernel for a rule.
+ * Kernel::Type::LOOKUP reads the table resolved by Kernel::step_row instead of the rule.
+ */
+
+template <typename RuleType>
+static void step_rule(const Kernel::Type type, const RuleType rule, const std::uint64_t *above,
+                      const std::uint64_t *row, const std::uint64_t *below, std::uint64_t *out,
+                      const unsigned int first_word, const unsigned int last_word, const unsigned int num_words,
+                      const unsigned int width, const unsigned int ends) {
+    switch (type) {
+        case Kernel::Type::SCALAR:
+            step_row_scalar(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+            break;
+#ifdef KERNEL_X86_VECTORS
+        case Kernel::Type::SSE2:
+            step_row_sse2(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+            break;
+        case Kernel::Type::AVX2:
+            step_row_avx2(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+            break;
+        case Kernel::Type::AVX512:
+            step_row_avx512(rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+            break;
+#endif
+        default:
+            throw std::invalid_argument("Kernel::step_row kernel is not word level or not supported.");
+    }
+}
+
+/**
+ * Kernel::best()
+ *
+ * Picks the widest kernel the running CPU supports, in the order AVX-512, AVX2, SSE2, then scalar.
+ * Checked at runtime so one binary runs well on any x86 CPU.
+ *
+ * @example
+ *
+ *      // Print the kernel a world will use by default
+ *      std::cout << Kernel::get_name(Kernel::best()) << std::endl;
+ *
+ * @return
+ *      The fastest supported Kernel::Type.
+ */
+
+Kernel::Type Kernel::best() {
+    const Type types[] = {Type::AVX512, Type::AVX2, Type::SSE2};
+    for (const Type type : types) {
+        if (is_supported(type)) {
+            return type;
+        }
+    }
+    return Type::SCALAR;
+}
+
+/**
+ * Kernel::is_supported(type)
+ *
+ * Checks if a kernel can be run on the current CPU.
+ *
+ * @param type
+ *      The kernel to check.
+ *
+ * @return
+ *      True if the kernel can be used to step a world.
+ */
+
+bool Kernel::is_supported(const Type type) {
+    switch (type) {
+        case Type::REFERENCE:
+        case Type::SCALAR:
+        case Type::LOOKUP:
+            return true;
+#ifdef KERNEL_X86_VECTORS
+        case Type::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Type::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Type::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * Kernel::get_name(type)
+ *
+ * Gets a human readable name for a kernel.
+ *
+ * @param type
+ *      The kernel to name.
+ *
+ * @return
+ *      The name of the kernel, such as "AVX2".
+ */
+
+std::string Kernel::get_name(const Type type) {
+    switch (type) {
+        case Type::REFERENCE:
+            return "reference";
+        case Type::SCALAR:
+            return "scalar";
+        case Type::LOOKUP:
+            return "lookup";
+        case Type::SSE2:
+            return "SSE2";
+        case Type::AVX2:
+            return "AVX2";
+        case Type::AVX512:
+            return "AVX-512";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * Kernel::get_lookup_table(rule)
+ *
+ * Finds the lookup table of a rule for Kernel::Type::LOOKUP. The tables of the fixed rules are built at
+ * compile time and found without a lock. The table of any other rule is built the first time it is asked
+ * for, under a lock, and kept for the life of the program, so the pointer can be held for as long as needed.
+ *
+ * @example
+ *
+ *      // Find the table once and step every row with it
+ *      const Kernel::LookupTable *table = Kernel::get_lookup_table(rule);
+ *      Kernel::step_row(Kernel::Type::LOOKUP, rule, above, row, below, out, 0, num_words, num_words, width,
+ *              Topology::Type::DEAD, table);
+ *
+ * @param rule
+ *      The rule to find the table of.
+ *
+ * @return
+ *      The table of the rule.
+ */
+
+const Kernel::LookupTable *Kernel::get_lookup_table(const Rule &rule) {
+    if (ConwayRule::matches(rule)) {
+        return &LOOKUP_TABLE<ConwayRule>;
+    } else if (HighLifeRule::matches(rule)) {
+        return &LOOKUP_TABLE<HighLifeRule>;
+    } else if (DayAndNightRule::matches(rule)) {
+        return &LOOKUP_TABLE<DayAndNightRule>;
+    } else if (SeedsRule::matches(rule)) {
+        return &LOOKUP_TABLE<SeedsRule>;
+    }
+    static std::mutex mutex;
+    static std::map<std::pair<std::uint16_t, std::uint16_t>, std::unique_ptr<LookupTable>> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<LookupTable> &table = tables[std::make_pair(rule.get_birth(), rule.get_survival())];
+    if (!table) {
+        table.reset(new LookupTable(rule.get_birth(), rule.get_survival()));
+    }
+    return table.get();
+}
+
+/**
+ * Kernel::step_row(type, rule, above, row, below, out, first_word, last_word, num_words, width, topology, table)
+ *
+ * Compute the next generation of the words [first_word, last_word) of one row of cells under a rule
+ * using the chosen kernel. Words of out outside the range are not written.
+ *
+ * @example
+ *
+ *      // Step all of row y of a grid that has at least 3 rows into the same row of another grid
+ *      Kernel::step_row(Kernel::best(), Rule::conway(), grid.get_row(y - 1), grid.get_row(y), grid.get_row(y + 1),
+ *              next.get_row(y), 0, grid.get_words_per_row(), grid.get_words_per_row(), grid.get_width(),
+ *              Topology::Type::DEAD);
+ *
+ * @param type
+ *      The kernel to use, which must be supported by the CPU.
+ *
+ * @param rule
+ *      The rule to step the cells with.
+ *
+ * @param above
+ *      The words of the row above, all 0 for a dead border.
+ *
+ * @param row
+ *      The words of the row being stepped.
+ *
+ * @param below
+ *      The words of the row below, all 0 for a dead border.
+ *
+ * @param out
+ *      The words to write the next generation of the row to. Bits past the width are written as 0.
+ *
+ * @param first_word
+ *      The first word of the row to step.
+ *
+ * @param last_word
+ *      The word after the last word of the row to step, at most num_words.
+ *
+ * @param num_words
+ *      The number of words in each row.
+ *
+ * @param width
+ *      The number of cells in each row.
+ *
+ * @param topology
+ *      The topology of the world, which decides the cells carried in past the left and right ends of the rows.
+ *      The rows above and below are not affected.
+ *
+ * @param table
+ *      Optional parameter. The table of the rule from Kernel::get_lookup_table, only read by
+ *      Kernel::Type::LOOKUP. Found from the rule for each call if not given, so callers stepping
+ *      many rows should find it once. Defaults to nullptr.
+ *
+ * @throws
+ *      std::invalid_argument if the kernel is Kernel::Type::REFERENCE, which is not word level,
+ *      or is not supported on this CPU.
+ */
+
+void Kernel::step_row(const Type type, const Rule &rule, const std::uint64_t *above, const std::uint64_t *row,
+                      const std::uint64_t *below, std::uint64_t *out, const unsigned int first_word,
+                      const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                      const Topology::Type topology, const LookupTable *table) {
+    //the cells past the ends of the row above, the row, and the row below, two bits each
+    unsigned int ends = 0;
+    if (topology!=Topology::Type::DEAD) {
+        ends = get_ends(above, width, topology) | (get_ends(row, width, topology) << 2)
+               | (get_ends(below, width, topology) << 4);
+    }
+    //the lookup table holds the rule, so needs no instantiation for it
+    if (type==Type::LOOKUP) {
+        step_row_lookup((table!=nullptr) ? *table : *get_lookup_table(rule), above, row, below, out, first_word,
+                        last_word, num_words, width, ends);
+        return;
+    }
+    //the fixed rules step with their masks compiled in, any other rule with its masks read at runtime
+    if (ConwayRule::matches(rule)) {
+        step_rule(type, ConwayRule(), above, row, below, out, first_word, last_word, num_words, width, ends);
+    } else if (HighLifeRule::matches(rule)) {
+        step_rule(type, HighLifeRule(), above, row, below, out, first_word, last_word, num_words, width, ends);
+    } else if (DayAndNightRule::matches(rule)) {
+        step_rule(type, DayAndNightRule(), above, row, below, out, first_word, last_word, num_words, width,
+                  ends);
+    } else if (SeedsRule::matches(rule)) {
+        step_rule(type, SeedsRule(), above, row, below, out, first_word, last_word, num_words, width, ends);
+    } else {
+        const RuntimeRule runtime_rule = {rule.get_birth(), rule.get_survival()};
+        step_rule(type, runtime_rule, above, row, below, out, first_word, last_word, num_words, width, ends);
+    }
+}
+
+/**
+ * Kernel::step_row_pair(type, rule, above, first, second, below, first_out, second_out, first_word, last_word,
+ *                       num_words, width, topology, table)
+ *
+ * Compute the next generation of the words [first_word, last_word) of two neighbouring rows of cells under a rule
+ * using the chosen kernel, as two calls to Kernel::step_row would. Kernel::Type::LOOKUP steps both rows
+ * from the same lookups, four cells at a time, and the other kernels step the rows one after the other.
+ *
+ * @example
+ *
+ *      // Step rows y and y + 1 of a grid with halo rows into the same rows of another grid
+ *      Kernel::step_row_pair(Kernel::Type::LOOKUP, rule, grid.get_row_unchecked(y - 1), grid.get_row_unchecked(y),
+ *              grid.get_row_unchecked(y + 1), grid.get_row_unchecked(y + 2), next.get_row_unchecked(y),
+ *              next.get_row_unchecked(y + 1), 0, grid.get_words_per_row(), grid.get_words_per_row(),
+ *              grid.get_width(), Topology::Type::DEAD, table);
+ *
+ * @param first
+ *      The words of the first row being stepped.
+ *
+ * @param second
+ *      The words of the second row being stepped, the row after the first.
+ *
+ * @param below
+ *      The words of the row below the second row, all 0 for a dead border.
+ *
+ * @param first_out
+ *      The words to write the next generation of the first row to.
+ *
+ * @param second_out
+ *      The words to write the next generation of the second row to.
+ *
+ * The other parameters are as for Kernel::step_row.
+ *
+ * @throws
+ *      std::invalid_argument if the kernel is Kernel::Type::REFERENCE, which is not word level,
+ *      or is not supported on this CPU.
+ */
+
+void Kernel::step_row_pair(const Type type, const Rule &rule, const std::uint64_t *above, const std::uint64_t *first,
+                           const std::uint64_t *second, const std::uint64_t *below, std::uint64_t *first_out,
+                           std::uint64_t *second_out, const unsigned int first_word, const unsigned int last_word,
+                           const unsigned int num_words, const unsigned int width, const Topology::Type topology,
+                           const LookupTable *table) {
+    if (type!=Type::LOOKUP) {
+        step_row(type, rule, above, first, second, first_out, first_word, last_word, num_words, width, topology, table);
+        step_row(type, rule, first, second, below, second_out, first_word, last_word, num_words, width, topology,
+                 table);
+        return;
+    }
+    //the cells past the ends of the four rows, two bits each
+    unsigned int ends = 0;
+    if (topology!=Topology::Type::DEAD) {
+        ends = get_ends(above, width, topology) | (get_ends(first, width, topology) << 2)
+               | (get_ends(second, width, topology) << 4) | (get_ends(below, width, topology) << 6);
+    }
+    step_row_pair_lookup((table!=nullptr) ? *table : *get_lookup_table(rule), above, first, second, below,
+                         first_out, second_out, first_word, last_word, num_words, width, ends);
+}
@@ -0,0 +1,50 @@
+/**
+ * Declares a Kernel namespace with word level functions for stepping bit-packed rows of a Grid.
+ * Rich documentation for the api and behaviour the Kernel namespace can be found in kernel.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the namespace.
+// #include ...
+#include "rule.h"
+#include "topology.h"
+#include <cstdint>
+#include <string>
+/**
+ * Declare the interface of the Kernel namespace for computing the next generation of a row 64 or more cells at a time.
+ */
+namespace Kernel {
+    /**
+     * The implementations available for stepping a world, from the per cell reference up to the widest vectors.
+     */
+    enum class Type {
+        REFERENCE,
+        SCALAR,
+        LOOKUP,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * The table of the next generation of every 4x4 block of cells under a rule, used by Kernel::Type::LOOKUP.
+     */
+    struct LookupTable;
+
+    Type best();
+    bool is_supported(const Type type);
+    std::string get_name(const Type type);
+    const LookupTable *get_lookup_table(const Rule &rule);
+    void step_row(const Type type, const Rule &rule, const std::uint64_t *above, const std::uint64_t *row,
+                  const std::uint64_t *below, std::uint64_t *out, const unsigned int first_word,
+                  const unsigned int last_word, const unsigned int num_words, const unsigned int width,
+                  const Topology::Type topology, const LookupTable *table = nullptr);
+    void step_row_pair(const Type type, const Rule &rule, const std::uint64_t *above, const std::uint64_t *first,
+                       const std::uint64_t *second, const std::uint64_t *below, std::uint64_t *first_out,
+                       std::uint64_t *second_out, const unsigned int first_word, const unsigned int last_word,
+                       const unsigned int num_words, const unsigned int width, const Topology::Type topology,
+                       const LookupTable *table = nullptr);
+};
@@ -0,0 +1,172 @@
+/**
+ * Implements a class representing a file mapped into memory, used as out-of-core storage for grids.
+ *      - Files can be created at a given size, or opened at their existing size.
+ *      - The whole file is mapped shared and writable, so writes to the memory are writes to the file,
+ *        and the operating system pages parts of it in and out of RAM as they are used.
+ *      - The mapping is removed and the file closed when the MappedFile is destroyed. Changes reach the
+ *        file even without MappedFile::sync, which only waits for them to be written out.
+ *
+ *      - Mapping uses the POSIX mmap interface. On other platforms constructing a MappedFile throws.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "mapped_file.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * map(path, size, create, descriptor)
+ *
+ * Helper to open a file, optionally resizing it, and map all of it into memory.
+ * Sets descriptor and size, and returns the address of the mapping.
+ */
+
+static void *map(const std::string &path, std::size_t &size, const bool create, int &descriptor) {
+#ifdef MAPPED_FILE_POSIX
+    descriptor = open(path.c_str(), create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0644);
+    if (descriptor<0) {
+        throw std::runtime_error("MappedFile::MappedFile could not open " + path + ".");
+    }
+    if (create) {
+        if (ftruncate(descriptor, (off_t) size)!=0) {
+            close(descriptor);
+            throw std::runtime_error("MappedFile::MappedFile could not resize " + path + ".");
+        }
+    } else {
+        struct stat status;
+        if (fstat(descriptor, &status)!=0) {
+            close(descriptor);
+            throw std::runtime_error("MappedFile::MappedFile could not read the size of " + path + ".");
+        }
+        size = (std::size_t) status.st_size;
+    }
+    //an empty file has nothing to map
+    if (size==0) {
+        return nullptr;
+    }
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (address==MAP_FAILED) {
+        close(descriptor);
+        throw std::runtime_error("MappedFile::MappedFile could not map " + path + ".");
+    }
+    return address;
+#else
+    (void) size;
+    (void) create;
+    descriptor = -1;
+    throw std::runtime_error("MappedFile::MappedFile memory mapped files are not supported on this platform.");
+#endif
+}
+
+/**
+ * MappedFile::MappedFile(path, size)
+ *
+ * Create a file of the desired size filled with 0 bytes, replacing any existing file, and map it.
+ *
+ * @example
+ *
+ *      // Make a 1 MiB file and write to it through memory
+ *      MappedFile file("world.map", 1 << 20);
+ *      ((char*) file.get_address())[0] = 1;
+ *
+ * @param path
+ *      The path of the file to create.
+ *
+ * @param size
+ *      The size of the file in bytes.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the file cannot be created or mapped.
+ */
+
+MappedFile::MappedFile(const std::string &path, const std::size_t size): size(size) {
+    address = map(path, this->size, true, descriptor);
+}
+
+/**
+ * MappedFile::MappedFile(path)
+ *
+ * Open an existing file and map all of it, keeping its contents.
+ *
+ * @param path
+ *      The path of the file to open.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the file does not exist or cannot be mapped.
+ */
+
+MappedFile::MappedFile(const std::string &path): size(0) {
+    address = map(path, size, false, descriptor);
+}
+
+/**
+ * MappedFile::~MappedFile()
+ *
+ * Unmaps and closes the file. Everything written through the mapping is kept in the file.
+ */
+
+MappedFile::~MappedFile() {
+#ifdef MAPPED_FILE_POSIX
+    if (address!=nullptr) {
+        munmap(address, size);
+    }
+    close(descriptor);
+#endif
+}
+
+/**
+ * MappedFile::get_address()
+ *
+ * Gets the address the file is mapped at, the first byte of the file.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The address of the mapping, or nullptr if the file is empty.
+ */
+
+void *MappedFile::get_address() const {
+    return address;
+}
+
+/**
+ * MappedFile::get_size()
+ *
+ * Gets the size of the file and of its mapping.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The size in bytes.
+ */
+
+std::size_t MappedFile::get_size() const {
+    return size;
+}
+
+/**
+ * MappedFile::sync()
+ *
+ * Writes every change made through the mapping out to the file, and waits until it is done.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the changes could not be written.
+ */
+
+void MappedFile::sync() {
+#ifdef MAPPED_FILE_POSIX
+    if (address!=nullptr && msync(address, size, MS_SYNC)!=0) {
+        throw std::runtime_error("MappedFile::sync could not write the changes.");
+    }
+#endif
+}
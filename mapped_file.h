@@ -0,0 +1,32 @@
+/**
+ * Declares a class representing a file mapped into memory, used as out-of-core storage for grids.
+ * Rich documentation for the api and behaviour the MappedFile class can be found in mapped_file.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the class.
+// #include ...
+#include <cstddef>
+#include <string>
+/**
+ * Declare the structure of the MappedFile class for reading and writing a file through memory.
+ */
+class MappedFile {
+    private:
+        int descriptor;
+        void *address;
+        std::size_t size;
+    public:
+        MappedFile(const std::string &path, const std::size_t size);
+        explicit MappedFile(const std::string &path);
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+        ~MappedFile();
+
+        void *get_address() const;
+        std::size_t get_size() const;
+        void sync();
+};
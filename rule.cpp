@@ -0,0 +1,279 @@
+/**
+ * Implements a class representing a Life-like rule, the neighbour counts at which cells are born and survive.
+ *      - New rules are Conway's Game of Life, B3/S23.
+ *      - Rules can be made from bit masks of the counts, or parsed from a rulestring such as "B36/S23".
+ *      - Rules can print themselves back as a rulestring.
+ *
+ *      - Rules where a dead cell with no alive neighbours is born are not supported.
+ *          - Every engine assumes the dead cells beyond the edges of a world, and empty space, stay dead.
+ *
+ *      - World applies its rule cell by cell with Rule::get_next on the reference kernel. The word level
+ *        kernels compile the most used rules into their inner loops, see kernel.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "rule.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include "grid.h"
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+//counts go from 0 to 8 neighbours
+static const std::uint16_t COUNT_MASK = 0x1FF;
+
+/**
+ * Rule::Rule()
+ *
+ * Construct the rule of Conway's Game of Life, B3/S23.
+ *
+ * @example
+ *
+ *      // Make the rule of Conway's Game of Life
+ *      Rule rule;
+ */
+
+Rule::Rule(): Rule(1U << 3, (1U << 2) | (1U << 3)) {
+}
+
+/**
+ * Rule::Rule(birth, survival)
+ *
+ * Construct a rule from bit masks of the neighbour counts at which cells are born and survive.
+ *
+ * @example
+ *
+ *      // Make HighLife, B36/S23
+ *      Rule rule((1 << 3) | (1 << 6), (1 << 2) | (1 << 3));
+ *
+ * @param birth
+ *      Bit n is set if a dead cell with n alive neighbours is born.
+ *
+ * @param survival
+ *      Bit n is set if an alive cell with n alive neighbours survives.
+ *
+ * @throws
+ *      std::invalid_argument if a mask has a bit set past 8 neighbours, or cells are born with 0 neighbours.
+ */
+
+Rule::Rule(const std::uint16_t birth, const std::uint16_t survival): birth(birth), survival(survival) {
+    if ((birth & ~COUNT_MASK) || (survival & ~COUNT_MASK)) {
+        throw std::invalid_argument("Rule::Rule counts must be from 0 to 8.");
+    }
+    if (birth & 1U) {
+        throw std::invalid_argument("Rule::Rule rules where cells are born with 0 neighbours are not supported.");
+    }
+}
+
+/**
+ * Rule::Rule(rulestring)
+ *
+ * Construct a rule from a rulestring in B/S notation, "B" followed by the counts at which cells are born,
+ * then "/S" followed by the counts at which cells survive. Letters may be either case.
+ *
+ * @example
+ *
+ *      // Make Day & Night
+ *      Rule rule("B3678/S34678");
+ *
+ *      // Make Seeds, where no cell survives
+ *      Rule rule("B2/S");
+ *
+ * @param rulestring
+ *      The rulestring to parse.
+ *
+ * @throws
+ *      std::invalid_argument if the rulestring is not in B/S notation, or is not a supported rule.
+ */
+
+Rule::Rule(const std::string &rulestring): Rule() {
+    std::uint16_t masks[2] = {0, 0};
+    const char letters[2] = {'B', 'S'};
+    std::size_t i = 0;
+    for (unsigned int part = 0; part < 2; part++) {
+        //the parts are separated by a slash
+        if (part==1) {
+            if (i>=rulestring.size() || rulestring[i]!='/') {
+                throw std::invalid_argument("Rule::Rule rulestring must be in the form B3/S23.");
+            }
+            i++;
+        }
+        if (i>=rulestring.size() || std::toupper((unsigned char) rulestring[i])!=letters[part]) {
+            throw std::invalid_argument("Rule::Rule rulestring must be in the form B3/S23.");
+        }
+        i++;
+        for (; i < rulestring.size() && rulestring[i]!='/'; i++) {
+            if (rulestring[i]<'0' || rulestring[i]>'8') {
+                throw std::invalid_argument("Rule::Rule rulestring counts must be from 0 to 8.");
+            }
+            masks[part] |= 1U << (rulestring[i]-'0');
+        }
+    }
+    if (i!=rulestring.size()) {
+        throw std::invalid_argument("Rule::Rule rulestring must be in the form B3/S23.");
+    }
+    *this = Rule(masks[0], masks[1]);
+}
+
+/**
+ * Rule::conway()
+ *
+ * Constructs the rule of Conway's Game of Life, B3/S23.
+ *
+ * @return
+ *      Returns a Rule for Conway's Game of Life.
+ */
+
+Rule Rule::conway() {
+    return Rule();
+}
+
+/**
+ * Rule::highlife()
+ *
+ * Constructs the rule of HighLife, B36/S23, where six neighbours also give birth.
+ *
+ * @return
+ *      Returns a Rule for HighLife.
+ */
+
+Rule Rule::highlife() {
+    return Rule((1U << 3) | (1U << 6), (1U << 2) | (1U << 3));
+}
+
+/**
+ * Rule::day_and_night()
+ *
+ * Constructs the rule of Day & Night, B3678/S34678, where alive and dead cells behave alike.
+ *
+ * @return
+ *      Returns a Rule for Day & Night.
+ */
+
+Rule Rule::day_and_night() {
+    return Rule((1U << 3) | (1U << 6) | (1U << 7) | (1U << 8),
+                (1U << 3) | (1U << 4) | (1U << 6) | (1U << 7) | (1U << 8));
+}
+
+/**
+ * Rule::seeds()
+ *
+ * Constructs the rule of Seeds, B2/S, where every cell dies each generation.
+ *
+ * @return
+ *      Returns a Rule for Seeds.
+ */
+
+Rule Rule::seeds() {
+    return Rule(1U << 2, 0);
+}
+
+/**
+ * Rule::get_birth()
+ *
+ * Gets the neighbour counts at which dead cells are born.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A mask with bit n set if a dead cell with n alive neighbours is born.
+ */
+
+std::uint16_t Rule::get_birth() const {
+    return birth;
+}
+
+/**
+ * Rule::get_survival()
+ *
+ * Gets the neighbour counts at which alive cells survive.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A mask with bit n set if an alive cell with n alive neighbours survives.
+ */
+
+std::uint16_t Rule::get_survival() const {
+    return survival;
+}
+
+/**
+ * Rule::get_name()
+ *
+ * Gets the rulestring of the rule in B/S notation.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Prints "B3/S23"
+ *      std::cout << Rule::conway().get_name() << std::endl;
+ *
+ * @return
+ *      The rulestring, such as "B36/S23".
+ */
+
+std::string Rule::get_name() const {
+    std::string name = "B";
+    for (unsigned int count = 0; count <= 8; count++) {
+        if ((birth >> count) & 1U) {
+            name += (char) ('0'+count);
+        }
+    }
+    name += "/S";
+    for (unsigned int count = 0; count <= 8; count++) {
+        if ((survival >> count) & 1U) {
+            name += (char) ('0'+count);
+        }
+    }
+    return name;
+}
+
+/**
+ * Rule::get_next(cell, num_neighbours)
+ *
+ * Applies the rule to one cell.
+ * The function should be callable from a constant context.
+ *
+ * @param cell
+ *      The value of the cell now.
+ *
+ * @param num_neighbours
+ *      The number of alive neighbours of the cell now, at most 8.
+ *
+ * @return
+ *      The value of the cell in the next generation.
+ */
+
+Cell Rule::get_next(const Cell cell, const unsigned int num_neighbours) const {
+    const std::uint16_t mask = (cell==Cell::ALIVE) ? survival : birth;
+    return ((mask >> num_neighbours) & 1U) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * Rule::operator==(other)
+ *
+ * Checks if two rules give every cell the same next generation.
+ *
+ * @return
+ *      True if both the birth and survival counts match.
+ */
+
+bool Rule::operator==(const Rule &other) const {
+    return birth==other.birth && survival==other.survival;
+}
+
+/**
+ * Rule::operator!=(other)
+ *
+ * Checks if two rules differ in the next generation of any cell.
+ *
+ * @return
+ *      True if the birth or survival counts differ.
+ */
+
+bool Rule::operator!=(const Rule &other) const {
+    return !(*this==other);
+}
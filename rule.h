@@ -0,0 +1,43 @@
+/**
+ * Declares a class representing a Life-like rule, the neighbour counts at which cells are born and survive.
+ * Rich documentation for the api and behaviour the Rule class can be found in rule.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the class.
+// #include ...
+#include "grid.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * Declare the structure of the Rule class for choosing which Life-like cellular automaton a world follows.
+ *
+ * Bit n of the birth mask is set if a dead cell with n alive neighbours is born, and bit n of the survival
+ * mask is set if an alive cell with n alive neighbours stays alive.
+ */
+class Rule {
+    private:
+        std::uint16_t birth;
+        std::uint16_t survival;
+    public:
+        Rule();
+        Rule(const std::uint16_t birth, const std::uint16_t survival);
+        explicit Rule(const std::string &rulestring);
+
+        static Rule conway();
+        static Rule highlife();
+        static Rule day_and_night();
+        static Rule seeds();
+
+        std::uint16_t get_birth() const;
+        std::uint16_t get_survival() const;
+        std::string get_name() const;
+        Cell get_next(const Cell cell, const unsigned int num_neighbours) const;
+
+        bool operator==(const Rule &other) const;
+        bool operator!=(const Rule &other) const;
+};
@@ -0,0 +1,591 @@
+/**
+ * Implements a class representing a 2d grid of cells stored as chunks allocated only where cells are alive.
+ *      - New cells are initialized to Cell::DEAD, and an empty grid of any size allocates nothing.
+ *      - Sparse grids can be made from a Grid and exported back to a Grid.
+ *      - Sparse grids can return counts of the alive and dead cells in O(1) time, and the bounding box of
+ *        the alive cells in time that grows with the number of chunks.
+ *      - Sparse grids can step themselves forward one generation of Conway's Game of Life, or another
+ *        Life-like rule set by SparseGrid::set_rule.
+ *
+ *      - Cells are stored in chunks of 64x64 cells, kept in an std::unordered_map keyed by chunk coordinate.
+ *          - Each chunk holds one 64 bit word per row, bit (x % 64) of the word is the cell in column x,
+ *            as in Grid. Bits past the width or height of the grid are always 0.
+ *          - A chunk is only allocated once one of its cells is set alive, and is freed by a step
+ *            that leaves it empty, so memory use follows the population rather than the area.
+ *
+ *      - SparseGrid::step only visits the allocated chunks and the chunks around them, as a cell can only
+ *        become alive next to an alive cell.
+ *          - Each visited chunk is copied with a 1 cell border from the chunks around it into a small
+ *            window of 3 words per row, which Kernel::step_row steps like a row of a Grid.
+ *          - The border is dead beyond the edges, or wrapped from the opposite edges on a torus.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "sparse_grid.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * get_key(cx, cy)
+ *
+ * Helper to pack the coordinate of a chunk into the key of the chunk map.
+ */
+
+static std::uint64_t get_key(const unsigned int cx, const unsigned int cy) {
+    return (std::uint64_t(cy) << 32) | cx;
+}
+
+/**
+ * SparseGrid::SparseGrid()
+ *
+ * Construct an empty sparse grid of size 0x0.
+ */
+
+SparseGrid::SparseGrid(): SparseGrid(0) {
+}
+
+/**
+ * SparseGrid::SparseGrid(square_size)
+ *
+ * Construct a square sparse grid with the desired size filled with dead cells.
+ *
+ * @param square_size
+ *      The edge size to use for the width and height of the grid.
+ */
+
+SparseGrid::SparseGrid(const unsigned int square_size): SparseGrid(square_size,square_size) {
+}
+
+/**
+ * SparseGrid::SparseGrid(width, height)
+ *
+ * Construct a sparse grid with the desired size filled with dead cells. No chunks are allocated,
+ * so a grid of any size takes the same small amount of memory.
+ *
+ * @example
+ *
+ *      // Make a 1,000,000 x 1,000,000 grid and place a glider in the middle
+ *      SparseGrid grid(1000000);
+ *      grid.set(500001, 500000, Cell::ALIVE);
+ *      ...
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ */
+
+SparseGrid::SparseGrid(const unsigned int width, const unsigned int height):
+    width(width), height(height), alive_cells(0) {
+}
+
+/**
+ * SparseGrid::SparseGrid(grid)
+ *
+ * Construct a sparse grid holding the same cells as a Grid, allocating only the chunks with alive cells.
+ *
+ * @param grid
+ *      The grid to copy the cells from.
+ */
+
+SparseGrid::SparseGrid(const Grid &grid): SparseGrid(grid.get_width(), grid.get_height()) {
+    //rows of a Grid are already split into words of 64 cells, one chunk row per word
+    for (unsigned int y = 0; y < get_height(); y++) {
+        const std::uint64_t *row = grid.get_row_unchecked(y);
+        for (unsigned int i = 0; i < grid.get_words_per_row(); i++) {
+            if (row[i]!=0) {
+                chunks[get_key(i, y/CHUNK_SIZE)].rows[y%CHUNK_SIZE] = row[i];
+                alive_cells += __builtin_popcountll(row[i]);
+            }
+        }
+    }
+}
+
+/**
+ * SparseGrid::get_width()
+ *
+ * Gets the current width of the grid.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The width of the grid.
+ */
+
+unsigned int SparseGrid::get_width() const {
+    return width;
+}
+
+/**
+ * SparseGrid::get_height()
+ *
+ * Gets the current height of the grid.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The height of the grid.
+ */
+
+unsigned int SparseGrid::get_height() const {
+    return height;
+}
+
+/**
+ * SparseGrid::get_total_cells()
+ *
+ * Gets the total number of cells in the grid, which may not fit in an unsigned int.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of total cells.
+ */
+
+std::uint64_t SparseGrid::get_total_cells() const {
+    return std::uint64_t(width)*height;
+}
+
+/**
+ * SparseGrid::get_alive_cells()
+ *
+ * Counts how many cells in the grid are alive, tracked as cells are written and stepped.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+
+std::uint64_t SparseGrid::get_alive_cells() const {
+    return alive_cells;
+}
+
+/**
+ * SparseGrid::get_dead_cells()
+ *
+ * Counts how many cells in the grid are dead.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+
+std::uint64_t SparseGrid::get_dead_cells() const {
+    return get_total_cells()-get_alive_cells();
+}
+
+/**
+ * SparseGrid::get_num_chunks()
+ *
+ * Gets the number of chunks allocated, each holding 64x64 cells.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of allocated chunks.
+ */
+
+std::size_t SparseGrid::get_num_chunks() const {
+    return chunks.size();
+}
+
+/**
+ * SparseGrid::get_bounds(x0, y0, x1, y1)
+ *
+ * Finds the smallest rectangle holding every alive cell, visiting only the allocated chunks.
+ * The function should be callable from a constant context.
+ *
+ * @param x0
+ *      Set to the x coordinate of the left edge of the box (inclusive).
+ *
+ * @param y0
+ *      Set to the y coordinate of the top edge of the box (inclusive).
+ *
+ * @param x1
+ *      Set to the x coordinate of the right edge of the box (exclusive).
+ *
+ * @param y1
+ *      Set to the y coordinate of the bottom edge of the box (exclusive).
+ *
+ * @return
+ *      True if any cell is alive, false if the grid is empty and the box was not set.
+ */
+
+bool SparseGrid::get_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const {
+    if (chunks.empty()) {
+        return false;
+    }
+    x0 = width;
+    y0 = height;
+    x1 = 0;
+    y1 = 0;
+    for (const auto &chunk : chunks) {
+        const unsigned int cx = chunk.first & 0xFFFFFFFFU, cy = chunk.first >> 32;
+        //every allocated chunk holds an alive cell, so has a first and last row and a union of its rows
+        std::uint64_t columns = 0;
+        unsigned int first = CHUNK_SIZE, last = 0;
+        for (unsigned int y = 0; y < CHUNK_SIZE; y++) {
+            if (chunk.second.rows[y]!=0) {
+                columns |= chunk.second.rows[y];
+                first = std::min(first, y);
+                last = y;
+            }
+        }
+        x0 = std::min(x0, cx*CHUNK_SIZE+__builtin_ctzll(columns));
+        x1 = std::max(x1, cx*CHUNK_SIZE+CHUNK_SIZE-__builtin_clzll(columns));
+        y0 = std::min(y0, cy*CHUNK_SIZE+first);
+        y1 = std::max(y1, cy*CHUNK_SIZE+last+1);
+    }
+    return true;
+}
+
+/**
+ * SparseGrid::get_rule()
+ *
+ * Gets the rule the grid is stepped with.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The rule in use, Rule::conway() unless changed by SparseGrid::set_rule.
+ */
+
+const Rule &SparseGrid::get_rule() const {
+    return rule;
+}
+
+/**
+ * SparseGrid::set_rule(rule)
+ *
+ * Sets the Life-like rule the grid is stepped with.
+ *
+ * @example
+ *
+ *      // Make a huge grid following HighLife
+ *      SparseGrid grid(1000000);
+ *      grid.set_rule(Rule::highlife());
+ *
+ * @param rule
+ *      The rule to use.
+ */
+
+void SparseGrid::set_rule(const Rule &rule) {
+    this->rule = rule;
+}
+
+/**
+ * SparseGrid::get_chunks_x()
+ *
+ * Private helper function to get the number of chunk columns covering the width.
+ */
+
+unsigned int SparseGrid::get_chunks_x() const {
+    return (width+CHUNK_SIZE-1)/CHUNK_SIZE;
+}
+
+/**
+ * SparseGrid::get_chunks_y()
+ *
+ * Private helper function to get the number of chunk rows covering the height.
+ */
+
+unsigned int SparseGrid::get_chunks_y() const {
+    return (height+CHUNK_SIZE-1)/CHUNK_SIZE;
+}
+
+/**
+ * SparseGrid::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate, Cell::DEAD if its chunk is not allocated.
+ * The function should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+
+Cell SparseGrid::get(const int x, const int y) const {
+    if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
+        const auto chunk = chunks.find(get_key(x/CHUNK_SIZE, y/CHUNK_SIZE));
+        if (chunk==chunks.end()) {
+            return Cell::DEAD;
+        }
+        return ((chunk->second.rows[y%CHUNK_SIZE] >> (x%CHUNK_SIZE)) & 1U) ? Cell::ALIVE : Cell::DEAD;
+    } else {
+        throw std::out_of_range("SparseGrid::get out of bounds.");
+    }
+}
+
+/**
+ * SparseGrid::set(x, y, value)
+ *
+ * Overwrites the value at the desired coordinate.
+ * Setting a cell alive allocates its chunk if needed, and setting the last alive cell of a chunk dead frees it.
+ *
+ * @param x
+ *      The x coordinate of the cell to update.
+ *
+ * @param y
+ *      The y coordinate of the cell to update.
+ *
+ * @param value
+ *      The value to be written to the selected cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+
+void SparseGrid::set(const int x, const int y, const Cell value) {
+    if (x>=0 && x<(int)get_width() && y>=0 && y<(int)get_height()) {
+        const std::uint64_t key = get_key(x/CHUNK_SIZE, y/CHUNK_SIZE);
+        const std::uint64_t mask = std::uint64_t(1) << (x%CHUNK_SIZE);
+        if (value==Cell::ALIVE) {
+            //value initializes a new chunk to all dead
+            std::uint64_t &row = chunks[key].rows[y%CHUNK_SIZE];
+            alive_cells += ((row & mask)==0);
+            row |= mask;
+        } else {
+            const auto chunk = chunks.find(key);
+            if (chunk==chunks.end()) {
+                return;
+            }
+            std::uint64_t &row = chunk->second.rows[y%CHUNK_SIZE];
+            if ((row & mask)!=0) {
+                row &= ~mask;
+                alive_cells--;
+                //free the chunk once it is empty
+                bool empty = true;
+                for (unsigned int i = 0; i < CHUNK_SIZE && empty; i++) {
+                    empty = (chunk->second.rows[i]==0);
+                }
+                if (empty) {
+                    chunks.erase(chunk);
+                }
+            }
+        }
+    } else {
+        throw std::out_of_range("SparseGrid::set out of bounds.");
+    }
+}
+
+/**
+ * SparseGrid::find_chunk(cx, cy, toroidal)
+ *
+ * Private helper function to find a chunk by coordinate, where the coordinate may be one chunk
+ * beyond any edge and wraps around if the grid is a torus.
+ *
+ * @return
+ *      The chunk, or nullptr if it is not allocated or is beyond an edge of a grid that does not wrap.
+ */
+
+const SparseGrid::Chunk *SparseGrid::find_chunk(const int cx, const int cy, const bool toroidal) const {
+    const int chunks_x = get_chunks_x(), chunks_y = get_chunks_y();
+    if ((cx<0 || cx>=chunks_x || cy<0 || cy>=chunks_y) && !toroidal) {
+        return nullptr;
+    }
+    const auto chunk = chunks.find(get_key((cx+chunks_x)%chunks_x, (cy+chunks_y)%chunks_y));
+    return (chunk==chunks.end()) ? nullptr : &chunk->second;
+}
+
+/**
+ * SparseGrid::step_chunk(cx, cy, toroidal, out)
+ *
+ * Private helper function to compute the next generation of one chunk.
+ *
+ * The chunk and a 1 cell border around it are gathered into a window of 3 words per row, the chunk
+ * itself in the middle word with the border cells in the top bit of the left word and the bottom bit
+ * of the right word. On the last chunk of a row that is cut short by the width, the cell past the edge
+ * is placed just past the last column in the middle word instead, as Grid padding would be.
+ * The same is done for the rows above and below. Each row of the window is then stepped by Kernel::step_row.
+ *
+ * @param cx
+ *      The chunk column.
+ *
+ * @param cy
+ *      The chunk row.
+ *
+ * @param toroidal
+ *      If true then the border wraps around to the opposite edges of the grid.
+ *
+ * @param out
+ *      Overwritten with the next generation of the chunk.
+ */
+
+void SparseGrid::step_chunk(const unsigned int cx, const unsigned int cy, const bool toroidal, Chunk &out) const {
+    const unsigned int x0 = cx*CHUNK_SIZE, y0 = cy*CHUNK_SIZE;
+    const unsigned int columns = (width-x0<CHUNK_SIZE) ? width-x0 : CHUNK_SIZE;
+    const unsigned int rows = (height-y0<CHUNK_SIZE) ? height-y0 : CHUNK_SIZE;
+    //the cell left of the chunk is the top bit of the chunk to the left, or the last column if that wrapped
+    const unsigned int west_bit = (cx==0) ? (width-1)%CHUNK_SIZE : CHUNK_SIZE-1;
+    //the 3x3 chunks around this one, looked up once
+    const Chunk *around[3][3];
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            around[dy+1][dx+1] = find_chunk((int) cx+dx, (int) cy+dy, toroidal);
+        }
+    }
+    std::uint64_t window[CHUNK_SIZE+2][3] = {};
+    //gathers the window row at index for local row of the chunk row at offset dy (-1, 0, or 1)
+    auto gather = [&](const unsigned int index, const int dy, const unsigned int local_row) {
+        const Chunk *west = around[dy+1][0], *middle = around[dy+1][1], *east = around[dy+1][2];
+        const std::uint64_t east_cell = east ? (east->rows[local_row] & 1U) : 0;
+        window[index][0] = west ? (((west->rows[local_row] >> west_bit) & 1U) << 63) : 0;
+        window[index][1] = middle ? middle->rows[local_row] : 0;
+        if (columns<CHUNK_SIZE) {
+            window[index][1] |= east_cell << columns;
+        } else {
+            window[index][2] = east_cell;
+        }
+    };
+    //the row above the chunk is the bottom row of the chunk above, or the last row if that wrapped
+    gather(0, -1, (cy==0) ? (height-1)%CHUNK_SIZE : CHUNK_SIZE-1);
+    for (unsigned int y = 0; y < rows; y++) {
+        gather(y+1, 0, y);
+    }
+    //the row below is placed just past the last row, which may be inside the chunk
+    gather(rows+1, 1, 0);
+    const std::uint64_t mask = (columns==CHUNK_SIZE) ? ~std::uint64_t(0) : ((std::uint64_t(1) << columns)-1);
+    std::uint64_t next[3];
+    for (unsigned int y = 0; y < CHUNK_SIZE; y++) {
+        if (y<rows) {
+            Kernel::step_row(Kernel::Type::SCALAR, rule, window[y], window[y+1], window[y+2], next, 1, 2, 3,
+                             3*CHUNK_SIZE, Topology::Type::DEAD);
+            out.rows[y] = next[1] & mask;
+        } else {
+            out.rows[y] = 0;
+        }
+    }
+}
+
+/**
+ * SparseGrid::step(toroidal)
+ *
+ * Take one step under the rule of the grid, giving the same result as World::step(toroidal) on the same cells
+ * with the same rule.
+ * Only the allocated chunks and the chunks around them are stepped, and chunks left empty are freed.
+ *
+ * @example
+ *
+ *      // Make a huge grid with a glider in it and step it, only a few chunks are ever allocated
+ *      SparseGrid grid(1000000);
+ *      ...
+ *      for (int i = 0; i < 1000; i++) {
+ *          grid.step();
+ *      }
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ *
+ * @throws
+ *      std::exception or sub-class if the grid is toroidal and only 1 cell wide or high, where cells
+ *      would wrap around to become their own neighbours.
+ */
+
+void SparseGrid::step(const bool toroidal) {
+    if (toroidal && (width==1 || height==1)) {
+        throw std::invalid_argument("SparseGrid::step torus must be at least 2 cells wide and high.");
+    }
+    const int chunks_x = get_chunks_x(), chunks_y = get_chunks_y();
+    //every allocated chunk and the chunks around it may hold alive cells in the next generation
+    std::unordered_set<std::uint64_t> candidates;
+    for (const auto &chunk : chunks) {
+        const int cx = chunk.first & 0xFFFFFFFFU, cy = chunk.first >> 32;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int nx = cx+dx, ny = cy+dy;
+                if (nx<0 || nx>=chunks_x || ny<0 || ny>=chunks_y) {
+                    if (!toroidal) {
+                        continue;
+                    }
+                    nx = (nx+chunks_x)%chunks_x;
+                    ny = (ny+chunks_y)%chunks_y;
+                }
+                candidates.insert(get_key(nx, ny));
+            }
+        }
+    }
+    //chunks are stepped from the current map into a new one, keeping only those with alive cells
+    std::unordered_map<std::uint64_t, Chunk> next_chunks;
+    std::uint64_t next_alive_cells = 0;
+    Chunk out;
+    for (const std::uint64_t key : candidates) {
+        step_chunk(key & 0xFFFFFFFFU, key >> 32, toroidal, out);
+        std::uint64_t population = 0;
+        for (unsigned int y = 0; y < CHUNK_SIZE; y++) {
+            population += __builtin_popcountll(out.rows[y]);
+        }
+        if (population!=0) {
+            next_chunks.emplace(key, out);
+            next_alive_cells += population;
+        }
+    }
+    chunks.swap(next_chunks);
+    alive_cells = next_alive_cells;
+}
+
+/**
+ * SparseGrid::for_each_word(visit)
+ *
+ * Calls visit for every word of a row holding an alive cell, in no particular order, with the row y,
+ * the index i of the word within the row as in Grid::get_row_unchecked(y)[i], and the word itself.
+ * Only the allocated chunks are visited, so this takes time that grows with the population, not the area.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Copy the alive cells of a sparse grid into a grid of the same size
+ *      sparse.for_each_word([&](const unsigned int y, const unsigned int i, const std::uint64_t word) {
+ *          grid.get_row_unchecked(y)[i] = word;
+ *      });
+ *
+ * @param visit
+ *      The function to call for each word.
+ */
+
+void SparseGrid::for_each_word(const std::function<void(const unsigned int y, const unsigned int i,
+                                                        const std::uint64_t word)> &visit) const {
+    for (const auto &chunk : chunks) {
+        const unsigned int cx = chunk.first & 0xFFFFFFFFU, cy = chunk.first >> 32;
+        for (unsigned int y = 0; y < CHUNK_SIZE; y++) {
+            if (chunk.second.rows[y]!=0) {
+                visit(cy*CHUNK_SIZE+y, cx, chunk.second.rows[y]);
+            }
+        }
+    }
+}
+
+/**
+ * SparseGrid::get_grid()
+ *
+ * Exports the cells to a dense Grid of the same size.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      A grid holding the same cells.
+ */
+
+Grid SparseGrid::get_grid() const {
+    Grid grid(width, height);
+    for_each_word([&grid](const unsigned int y, const unsigned int i, const std::uint64_t word) {
+        grid.get_row_unchecked(y)[i] = word;
+    });
+    grid.set_alive_cells(alive_cells);
+    return grid;
+}
@@ -0,0 +1,66 @@
+/**
+ * Declares a class representing a 2d grid of cells stored as chunks allocated only where cells are alive.
+ * Rich documentation for the api and behaviour the SparseGrid class can be found in sparse_grid.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the class.
+// #include ...
+#include "grid.h"
+#include "rule.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+/**
+ * Declare the structure of the SparseGrid class for representing huge, mostly empty grids of cells.
+ *
+ * The grid is divided into chunks of SparseGrid::CHUNK_SIZE by SparseGrid::CHUNK_SIZE cells, bit-packed
+ * one word per row as in Grid. Only chunks with alive cells are allocated.
+ */
+class SparseGrid {
+    private:
+        /**
+         * A square of 64x64 cells, bit (x % 64) of rows[y % 64] holds the cell at x,y.
+         */
+        struct Chunk {
+            std::uint64_t rows[64];
+        };
+
+        unsigned int width;
+        unsigned int height;
+        std::unordered_map<std::uint64_t, Chunk> chunks;
+        std::uint64_t alive_cells;
+        Rule rule;
+
+        unsigned int get_chunks_x() const;
+        unsigned int get_chunks_y() const;
+        const Chunk *find_chunk(const int cx, const int cy, const bool toroidal) const;
+        void step_chunk(const unsigned int cx, const unsigned int cy, const bool toroidal, Chunk &out) const;
+    public:
+        static const unsigned int CHUNK_SIZE = 64;
+
+        SparseGrid();
+        explicit SparseGrid(const unsigned int square_size);
+        SparseGrid(const unsigned int width, const unsigned int height);
+        explicit SparseGrid(const Grid &grid);
+
+        unsigned int get_width() const;
+        unsigned int get_height() const;
+        std::uint64_t get_total_cells() const;
+        std::uint64_t get_alive_cells() const;
+        std::uint64_t get_dead_cells() const;
+        std::size_t get_num_chunks() const;
+        bool get_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const;
+        const Rule &get_rule() const;
+        void set_rule(const Rule &rule);
+        Cell get(const int x, const int y) const;
+        void set(const int x, const int y, const Cell value);
+        void step(const bool toroidal=false);
+        void for_each_word(const std::function<void(const unsigned int y, const unsigned int i,
+                                                    const std::uint64_t word)> &visit) const;
+        Grid get_grid() const;
+};
@@ -0,0 +1,173 @@
+/**
+ * Implements a class representing a fixed set of persistent worker threads.
+ *      - Threads are created once when the pool is constructed and joined when it is destroyed,
+ *        so no threads are created while stepping a world.
+ *      - ThreadPool::run hands the same task to every thread, each called with its own index,
+ *        then waits for all of them to finish. This is the only synchronization per call.
+ *      - The calling thread takes part as thread 0, so a pool of N threads starts N - 1 workers.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "thread_pool.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+/**
+ * ThreadPool::ThreadPool(num_threads)
+ *
+ * Construct a pool and start its worker threads.
+ *
+ * @example
+ *
+ *      // Make a pool that runs tasks on 4 threads, the caller and 3 workers
+ *      ThreadPool pool(4);
+ *
+ * @param num_threads
+ *      The number of threads tasks are run on, including the calling thread.
+ *
+ * @throws
+ *      std::invalid_argument if num_threads is 0.
+ */
+
+ThreadPool::ThreadPool(const unsigned int num_threads):
+    task(nullptr), generation(0), remaining(0), stopping(false) {
+    if (num_threads==0) {
+        throw std::invalid_argument("ThreadPool::ThreadPool needs at least 1 thread.");
+    }
+    //thread 0 is the caller of run, so only the others need starting
+    for (unsigned int i = 1; i < num_threads; i++) {
+        workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+/**
+ * ThreadPool::~ThreadPool()
+ *
+ * Wakes every worker thread to tell it to stop and waits for them to exit.
+ */
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * ThreadPool::get_num_threads()
+ *
+ * Gets the number of threads tasks are run on, including the calling thread.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of threads.
+ */
+
+unsigned int ThreadPool::get_num_threads() const {
+    return workers.size()+1;
+}
+
+/**
+ * ThreadPool::run(task)
+ *
+ * Run a task once on every thread of the pool, and wait for every thread to finish it.
+ * Each call of the task is passed the index of its thread, from 0 to ThreadPool::get_num_threads() - 1,
+ * which it uses to pick its share of the work. Calls from different threads are run one after another.
+ *
+ * @example
+ *
+ *      // Make a pool
+ *      ThreadPool pool(4);
+ *
+ *      // Each thread fills its quarter of a vector
+ *      std::vector<int> values(100);
+ *      pool.run([&](const unsigned int index) {
+ *          for (unsigned int i = index * 25; i < (index + 1) * 25; i++) {
+ *              values[i] = i;
+ *          }
+ *      });
+ *
+ * @param task
+ *      The function to call on every thread.
+ *
+ * @throws
+ *      Rethrows the first exception thrown by the task on any thread, once all threads have finished.
+ */
+
+void ThreadPool::run(const std::function<void(const unsigned int)> &task) {
+    std::lock_guard<std::mutex> serial(run_mutex);
+    //publish the task to the workers
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        remaining = workers.size();
+        error = nullptr;
+        generation++;
+    }
+    start.notify_all();
+    //the calling thread does the work of thread 0
+    std::exception_ptr caller_error = nullptr;
+    try {
+        task(0);
+    } catch (...) {
+        caller_error = std::current_exception();
+    }
+    //wait for the workers to finish before the task goes out of scope
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return remaining==0; });
+    this->task = nullptr;
+    if (caller_error) {
+        std::rethrow_exception(caller_error);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * ThreadPool::work(index)
+ *
+ * Private helper function run by each worker thread. Sleeps until a new task is published by
+ * ThreadPool::run, runs it with the index of the thread, and reports back when it is done.
+ *
+ * @param index
+ *      The index of the worker thread, from 1 to ThreadPool::get_num_threads() - 1.
+ */
+
+void ThreadPool::work(const unsigned int index) {
+    unsigned long seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        start.wait(lock, [&]() { return stopping || generation!=seen_generation; });
+        if (stopping) {
+            return;
+        }
+        seen_generation = generation;
+        const std::function<void(const unsigned int)> &current = *task;
+        lock.unlock();
+        std::exception_ptr task_error = nullptr;
+        try {
+            current(index);
+        } catch (...) {
+            task_error = std::current_exception();
+        }
+        lock.lock();
+        if (task_error && !error) {
+            error = task_error;
+        }
+        if (--remaining==0) {
+            done.notify_one();
+        }
+    }
+}
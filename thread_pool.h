@@ -0,0 +1,42 @@
+/**
+ * Declares a class representing a fixed set of persistent worker threads.
+ * Rich documentation for the api and behaviour the ThreadPool class can be found in thread_pool.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the class.
+// #include ...
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+/**
+ * Declare the structure of the ThreadPool class for running one task per thread and waiting for them all.
+ */
+class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::mutex run_mutex;
+        std::condition_variable start;
+        std::condition_variable done;
+        const std::function<void(const unsigned int)> *task;
+        unsigned long generation;
+        unsigned int remaining;
+        bool stopping;
+        std::exception_ptr error;
+        void work(const unsigned int index);
+    public:
+        explicit ThreadPool(const unsigned int num_threads);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool &other) = delete;
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+
+        unsigned int get_num_threads() const;
+        void run(const std::function<void(const unsigned int)> &task);
+};
@@ -0,0 +1,113 @@
+/**
+ * Implements a Topology namespace with the ways the edges of a world can be joined.
+ *      - Topology::Type::DEAD treats every cell beyond the edges as Cell::DEAD.
+ *      - Topology::Type::TORUS wraps the left edge to the right edge and the top edge to the bottom edge.
+ *      - Topology::Type::CYLINDER wraps the left edge to the right edge, the cells above the top and below
+ *        the bottom are Cell::DEAD.
+ *      - Topology::Type::REFLECT mirrors the world in each edge, the cell just beyond an edge is the cell on it.
+ *
+ *      - Worlds take a topology once per World::step or World::advance, and hand it to the parts that
+ *        step them as a constant.
+ *          - The per cell reference is a template over Topology::Edges, so none of its tests of the topology
+ *            are left in the loop over the neighbours.
+ *          - The word level kernels only look at the topology for the cells carried in at the ends of a row,
+ *            and the halo rows above and below are filled once per step, see Grid::fill_halo.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#include "topology.h"
+
+// Include the minimal number of headers needed to support your implementation.
+// #include ...
+#include <stdexcept>
+#include <string>
+
+/**
+ * Topology::get_name(type)
+ *
+ * Gets a human readable name for a topology, which Topology::from_name reads back.
+ *
+ * @param type
+ *      The topology to name.
+ *
+ * @return
+ *      The name of the topology, such as "torus".
+ */
+
+std::string Topology::get_name(const Type type) {
+    switch (type) {
+        case Type::DEAD:
+            return "dead";
+        case Type::TORUS:
+            return "torus";
+        case Type::CYLINDER:
+            return "cylinder";
+        case Type::REFLECT:
+            return "reflect";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * Topology::from_name(name)
+ *
+ * Finds the topology with a name given by Topology::get_name.
+ *
+ * @example
+ *
+ *      // Step a world as a cylinder
+ *      world.step(Topology::from_name("cylinder"));
+ *
+ * @param name
+ *      The name of the topology.
+ *
+ * @return
+ *      The topology with the name.
+ *
+ * @throws
+ *      std::invalid_argument if no topology has the name.
+ */
+
+Topology::Type Topology::from_name(const std::string &name) {
+    const Type types[] = {Type::DEAD, Type::TORUS, Type::CYLINDER, Type::REFLECT};
+    for (const Type type : types) {
+        if (get_name(type)==name) {
+            return type;
+        }
+    }
+    throw std::invalid_argument("Topology::from_name topology must be dead, torus, cylinder or reflect.");
+}
+
+/**
+ * Topology::wraps_x(type)
+ *
+ * Checks if the left and right edges of a topology are joined.
+ *
+ * @param type
+ *      The topology to check.
+ *
+ * @return
+ *      True for Topology::Type::TORUS and Topology::Type::CYLINDER.
+ */
+
+bool Topology::wraps_x(const Type type) {
+    return type==Type::TORUS || type==Type::CYLINDER;
+}
+
+/**
+ * Topology::wraps_y(type)
+ *
+ * Checks if the top and bottom edges of a topology are joined.
+ *
+ * @param type
+ *      The topology to check.
+ *
+ * @return
+ *      True for Topology::Type::TORUS.
+ */
+
+bool Topology::wraps_y(const Type type) {
+    return type==Type::TORUS;
+}
@@ -0,0 +1,68 @@
+/**
+ * Declares a Topology namespace with the ways the edges of a world can be joined.
+ * Rich documentation for the api and behaviour the Topology namespace can be found in topology.cpp.
+ *
+ * @author 951939
+ * @date March, 2020
+ */
+#pragma once
+
+// Add the minimal number of includes you need in order to declare the namespace.
+// #include ...
+#include <string>
+
+/**
+ * Declare the interface of the Topology namespace for choosing what lies beyond the edges of a world.
+ */
+namespace Topology {
+    /**
+     * The topologies a world can be stepped with.
+     */
+    enum class Type {
+        DEAD,
+        TORUS,
+        CYLINDER,
+        REFLECT
+    };
+
+    std::string get_name(const Type type);
+    Type from_name(const std::string &name);
+    bool wraps_x(const Type type);
+    bool wraps_y(const Type type);
+
+    /**
+     * A topology fixed at compile time, for loops that look past the edges for every cell.
+     * Every test of the topology is a constant, so only the test for being past an edge is left.
+     */
+    template <Type TYPE>
+    struct Edges {
+        static const bool WRAP_X = TYPE==Type::TORUS || TYPE==Type::CYLINDER;
+        static const bool WRAP_Y = TYPE==Type::TORUS;
+        static const bool REFLECT = TYPE==Type::REFLECT;
+
+        /**
+         * Maps a coordinate at most 1 past either end of an axis of size cells to the cell read there,
+         * or -1 if it is dead.
+         */
+        static int get_coordinate(const int i, const int size, const bool wrap) {
+            if (i>=0 && i<size) {
+                return i;
+            }
+            if (wrap) {
+                return (i+size)%size;
+            }
+            if (REFLECT) {
+                return (i<0) ? -1-i : 2*size-1-i;
+            }
+            return -1;
+        }
+
+        static int get_x(const int x, const int width) {
+            return get_coordinate(x, width, WRAP_X);
+        }
+
+        static int get_y(const int y, const int height) {
+            return get_coordinate(y, height, WRAP_Y);
+        }
+    };
+};
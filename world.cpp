@@ -10,13 +10,131 @@
  *
  *      - Stepping a world forward in time applies the rules of Conway's Game of Life.
  *          - https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
+ *          - Any other Life-like rule, such as HighLife, can be set with World::set_rule. Every kernel
+ *            and engine follows the rule, see rule.cpp.
  *
  *      - Worlds have a private helper function used to count the number of alive cells in a 3x3 neighbours
  *        around a given cell.
+ *          - This is the readable reference definition of the rules. Stepping is done by the word level
+ *            functions in the Kernel namespace, which update 64 or more cells at a time with bitwise logic.
+ *          - The kernel is picked at runtime by Kernel::best() and can be changed with World::set_kernel,
+ *            including back to Kernel::Type::REFERENCE to step cell by cell.
+ *          - Both grids are given a halo row above and below, see Grid::set_halo. Before each step the halo
+ *            is filled with dead cells or with the opposite edge, so every row reads the rows around it
+ *            without checking for the top and bottom edges.
+ *
+ *      - Steps can be run in parallel on a persistent ThreadPool set up by World::set_threads.
+ *          - The grid is split into one horizontal band of rows per thread.
+ *          - Bands only read the current state and only write their own rows of the next state,
+ *            so the threads only need to synchronize once per step, before the grids are swapped.
+ *          - Worlds copied from one another share their pool.
+ *
+ *      - Worlds are divided into tiles one storage word (64 cells) wide and World::TILE_ROWS rows high.
+ *          - Each tile has a flag for whether any of its cells changed in the last step.
+ *          - A tile can only change if it or one of the 8 tiles around it changed in the last step,
+ *            otherwise it is skipped, so the cost of a step follows the activity rather than the area.
+ *          - A skipped tile is already correct in the next state grid, as that holds the step before,
+ *            which was the same.
+ *          - Every tile is marked as changed whenever the state is replaced, as on construction or resize,
+ *            or when the topology differs from the last step.
+ *
+ *      - Worlds keep the bounding box of their alive cells, see World::get_bounds.
+ *          - No cell can be born more than one cell outside the box, so each step only visits the rows and
+ *            words of the box grown by one cell, and finds the box of the next generation as it goes.
+ *          - On a torus the box is the smallest span of rows and of columns holding every alive cell, and may
+ *            wrap around an edge, so a pattern sitting across an edge is not taken to fill the whole world.
+ *          - Cells left in the next state grid outside the grown box, from the generation before last,
+ *            are cleared before the step, so the grid is dead everywhere the step does not write.
+ *          - The box is found again from scratch whenever the state is replaced.
+ *
+ *      - World::advance uses temporal blocking on worlds too large to stay in cache between generations.
+ *          - The rows within World::get_block_depth() rows of the bounding box are split into strips, and
+ *            each strip is copied out with that many extra rows above and below, stepped that many
+ *            generations in a buffer small enough to stay in cache, and only its own rows are written back.
+ *            The extra rows are wrong by one more row on each side every generation, so after k generations
+ *            exactly the rows of the strip are right, and each generation reads the grid from memory about
+ *            1/k as often.
+ *          - Strips span whole rows, so the horizontal wrap of a torus and the edge of the grid are left to
+ *            Kernel::step_row as in a single step. Strips are shared out between the threads of the pool.
+ *          - Only the end of each block is a generation the world passes through, so the history is restarted
+ *            after each block. If a block ends on a state an earlier block ended on, the world is repeating
+ *            and the remaining generations are stepped one at a time so the cycle is found and skipped.
+ *
+ *      - Unbounded worlds can be advanced by the HashLife engine instead, chosen by World::set_engine.
+ *          - The current state is loaded into a HashLife universe, advanced, and the box around its alive
+ *            cells is exported back to the grids. See hashlife.cpp.
+ *          - The universe is kept in the world with the memoized futures of its nodes, so later jumps reuse
+ *            them. It is only loaded again once the grids have been stepped or replaced, and is let go once
+ *            it holds more than World::HASHLIFE_NODES nodes.
+ *          - The universe is an unbounded plane, so it only stands in for unbounded worlds with dead edges.
+ *            Bounded worlds and other topologies are stepped by the grids, as are single generations,
+ *            which HashLife takes no faster. Every engine gives the same result however the steps are split.
+ *
+ *      - Worlds can also be advanced by the sparse engine, see sparse_grid.cpp.
+ *          - The cells are moved into a SparseGrid on the first step, which only keeps the 64x64 chunks holding
+ *            alive cells, and the grids are let go. The SparseGrid keeps the state for as long as the engine is
+ *            used, so the memory of the world and the cost of each step follow the population, not the area.
+ *          - World::World(SparseGrid&&) starts a world in the sparse engine without ever making the grids,
+ *            for worlds far too large to hold densely.
+ *          - Each step only visits the allocated chunks and those around them, however large the world.
+ *            The bounding box and the hash of the state are found from the chunks after each run of steps.
+ *          - A Grid is only made from the chunks when World::get_state asks for one. The grids are made again
+ *            when the state leaves the engine, by a change of engine, a topology the engine cannot step, a
+ *            resize, or mapping the world. A mapped world keeps its grids in its file, rewriting only the
+ *            words of the chunks, so the file stays up to date.
+ *
+ *      - Worlds can also be advanced by the event driven engine, see event_grid.cpp.
+ *          - The current state is loaded into an EventGrid on the first step, which keeps the number of alive
+ *            neighbours of every cell and updates them as cells are born and die. The EventGrid is kept
+ *            between steps, and is only made again when the state is replaced or leaves the engine.
+ *          - Each step only looks at the cells that changed in the last step and their neighbours, in time
+ *            that grows with the number of births and deaths rather than the area or the population.
+ *          - The grids are kept in step by flipping the bits of the cells that changed, which also updates
+ *            the hash word by word. The bounding box is kept by the EventGrid, so no step scans the world,
+ *            and cycles are found and skipped as with the grids.
+ *
+ *      - Worlds detect when they have become a still life or entered a cycle.
+ *          - A 64 bit hash of the state is kept up to date as words change while stepping, made by adding
+ *            together a hash of each word and its position, so only changed words need rehashing.
+ *          - The hashes of the last World::HISTORY_SIZE generations are remembered. When the hash of a new
+ *            generation matches an earlier one the state is copied, and is compared exactly once the
+ *            candidate period has passed again, so a hash collision cannot cause a false cycle.
+ *          - The hashes are kept in a ring, chained into World::HISTORY_BUCKETS buckets by hash, all allocated
+ *            with the world. With the scratch of each band also kept in the world, a step allocates nothing.
+ *          - Once a cycle is confirmed World::advance skips the remaining whole periods, and
+ *            World::get_period and World::get_cycle_start report it. A still life has a period of 1.
+ *          - The history is forgotten whenever the state is replaced or the topology changes.
+ *
+ *      - Worlds can keep both grids in a memory mapped file, see mapped_file.cpp, for worlds larger than RAM.
+ *          - World::create_mapped(path) writes the world to a new file and carries on stepping it there.
+ *            World::open_mapped(path) picks up a world from such a file as it was left, reading only
+ *            the header, the cells are paged in by the operating system as the steps reach them.
+ *          - The file is a header holding the size, generation, and which region is the current state,
+ *            followed by two regions holding a grid each, with halo rows, see Grid::get_mapped_size.
+ *          - The header is rewritten after every generation. Steps swap which region is current, as the
+ *            grids are swapped in memory, so no cells are copied.
+ *          - A world stops using the file if its state is replaced by a grid of a different size, as
+ *            by World::resize, or it is copied. A copied world keeps its cells in memory.
+ *
+ *      - Worlds can be made unbounded with World::set_unbounded, standing in for an infinite plane.
+ *          - Before each step with dead edges, if any cell on the edge of the world is alive the grids
+ *            are regrown around the alive cells with a margin of dead cells on every side, so no cell is
+ *            lost at the edge. The margin is World::UNBOUNDED_MARGIN plus a quarter of the size of the
+ *            pattern, so a growing pattern is regrown a number of times that is only logarithmic in its size.
+ *          - Every World::UNBOUNDED_MARGIN generations the margins are checked, and if any has grown to more
+ *            than twice its size, as behind a spaceship, the grids are cut back around the alive cells.
+ *          - The plane coordinate of the top left cell is kept as the origin, see World::get_state(x0, y0).
+ *          - The HashLife engine exports the box around every alive cell of its universe, and the sparse
+ *            engine steps in runs no longer than the dead margin, so all engines agree on an unbounded plane.
  *
  *      - Updating the world state can conditionally be performed using a toroidal topology.
  *          - Moving off the left edge you appear on the right edge and vice versa.
  *          - Moving off the top edge you appear on the bottom edge and vice versa.
+ *          - Worlds can also be stepped as a cylinder, wrapping only the left and right edges, or with
+ *            reflecting edges, where the cells just beyond an edge mirror the cells on it, see topology.cpp.
+ *          - World::step and World::advance take the topology once and hand it on as a template argument,
+ *            so the per cell reference has no test of it in its inner loop. Engines that only know dead
+ *            edges or a torus fall back to stepping the grid for the other topologies.
  *
  * @author 951939
  * @date March, 2020
@@ -25,7 +143,220 @@
 
 // Include the minimal number of headers needed to support your implementation.
 // #include ...
+#include "event_grid.h"
 #include "grid.h"
+#include "grid_view.h"
+#include "hashlife.h"
+#include "kernel.h"
+#include "mapped_file.h"
+#include "sparse_grid.h"
+#include "thread_pool.h"
+#include "topology.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * The header at the start of a mapped world file, followed by the two grid regions.
+ * The header is rewritten after every generation, so the file can be reopened where it was left.
+ */
+struct MappedHeader {
+    char magic[8];
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t current;
+    std::uint32_t reserved;
+    std::uint64_t generation;
+    std::uint64_t state_hash;
+    std::uint64_t alive_cells[2];
+};
+
+static const char MAPPED_MAGIC[8] = {'G', 'O', 'L', 'W', 'O', 'R', 'L', 'D'};
+//the regions start on a cache line after the header
+static const std::size_t MAPPED_HEADER_SIZE = 64;
+
+/**
+ * mix(value)
+ *
+ * Helper to scramble the bits of a 64 bit value (the splitmix64 finalizer).
+ */
+
+static std::uint64_t mix(std::uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * hash_word(index, word)
+ *
+ * Helper to hash a storage word together with its position in the grid. The hash of a state is the sum of
+ * the hashes of its words, so changing a word changes the hash by the difference of its two word hashes.
+ * Dead words hash to 0, so a state can be hashed from its alive words alone, as the sparse engine does.
+ */
+
+static std::uint64_t hash_word(const std::uint64_t index, const std::uint64_t word) {
+    return (word!=0) ? mix(word ^ mix(index+0x9E3779B97F4A7C15ULL)) : 0;
+}
+
+/**
+ * get_margin(extent)
+ *
+ * Helper to get the number of dead cells an unbounded world keeps on each side of a pattern
+ * that is extent cells across.
+ *
+ * @throws
+ *      std::length_error if the pattern and its margins are too large for a grid.
+ */
+
+static std::uint64_t get_margin(const std::uint64_t extent) {
+    const std::uint64_t margin = World::UNBOUNDED_MARGIN+extent/4;
+    if (extent+2*margin>(std::uint64_t) std::numeric_limits<int>::max()) {
+        throw std::length_error("World unbounded pattern too large.");
+    }
+    return margin;
+}
+
+/**
+ * get_pieces(start, count, size, pieces)
+ *
+ * Helper to split a span of count cells from start, which may wrap around a ring of size cells,
+ * into at most two spans [pieces[i][0], pieces[i][1]) that do not wrap.
+ *
+ * @return
+ *      The number of pieces.
+ */
+
+static unsigned int get_pieces(const unsigned int start, const unsigned int count, const unsigned int size,
+                               unsigned int pieces[2][2]) {
+    if (count==0) {
+        return 0;
+    }
+    if ((std::uint64_t) start+count<=size) {
+        pieces[0][0] = start;
+        pieces[0][1] = start+count;
+        return 1;
+    }
+    pieces[0][0] = start;
+    pieces[0][1] = size;
+    pieces[1][0] = 0;
+    pieces[1][1] = start+count-size;
+    return 2;
+}
+
+/**
+ * get_word_pieces(start, count, size, pieces)
+ *
+ * Helper to find the storage words of a row holding a span of count cells from start, which may wrap
+ * around a row of size cells, as at most two spans of words [pieces[i][0], pieces[i][1]).
+ *
+ * @return
+ *      The number of pieces.
+ */
+
+static unsigned int get_word_pieces(const unsigned int start, const unsigned int count, const unsigned int size,
+                                    unsigned int pieces[2][2]) {
+    const unsigned int num_pieces = get_pieces(start, count, size, pieces);
+    for (unsigned int i = 0; i < num_pieces; i++) {
+        pieces[i][0] = pieces[i][0]/64;
+        pieces[i][1] = (pieces[i][1]-1)/64+1;
+    }
+    //both ends of a wrapping span can share the word they meet in
+    if (num_pieces==2 && pieces[1][1]>=pieces[0][0]) {
+        pieces[0][0] = 0;
+        return 1;
+    }
+    return num_pieces;
+}
+
+/**
+ * grow_span(start, count, margin, size, toroidal, new_start, new_count)
+ *
+ * Helper to grow a span of count cells from start by margin cells at each end, wrapping around a ring of
+ * size cells if toroidal and stopping at the ends otherwise. An empty span stays empty.
+ */
+
+static void grow_span(const unsigned int start, const unsigned int count, const unsigned int margin,
+                      const unsigned int size, const bool toroidal, unsigned int &new_start, unsigned int &new_count) {
+    if (count==0) {
+        new_start = 0;
+        new_count = 0;
+    } else if ((std::uint64_t) count+2*margin>=size || (!toroidal && (std::uint64_t) start+count>size)) {
+        new_start = 0;
+        new_count = size;
+    } else if (toroidal) {
+        new_start = (start+size-margin)%size;
+        new_count = count+2*margin;
+    } else {
+        new_start = (start>margin) ? start-margin : 0;
+        new_count = (((std::uint64_t) start+count+margin<size) ? start+count+margin : size)-new_start;
+    }
+}
+
+/**
+ * find_span(bits, size, start, count, toroidal, span_start, span_count)
+ *
+ * Helper to find the smallest span holding every set bit of a ring of size bits, all of which are within
+ * the span of count bits from start. If that span is the whole ring of a torus, the span found is the ring
+ * less its longest run of clear bits, which may wrap around the end.
+ *
+ * @return
+ *      True if any bit is set, false if there are none and the span was not set.
+ */
+
+static bool find_span(const std::uint64_t *bits, const unsigned int size, const unsigned int start,
+                      const unsigned int count, const bool toroidal, unsigned int &span_start, unsigned int &span_count) {
+    const auto is_set = [bits](const unsigned int i) {
+        return (bits[i/64] >> (i%64)) & 1;
+    };
+    if (count<size || !toroidal) {
+        unsigned int first = 0;
+        while (first<count && !is_set((start+first)%size)) {
+            first++;
+        }
+        if (first==count) {
+            return false;
+        }
+        unsigned int last = count-1;
+        while (!is_set((start+last)%size)) {
+            last--;
+        }
+        span_start = (start+first)%size;
+        span_count = last-first+1;
+        return true;
+    }
+    unsigned int set = 0;
+    while (set<size && !is_set(set)) {
+        set++;
+    }
+    if (set==size) {
+        return false;
+    }
+    //walk once around the ring from a set bit back to it, measuring each run of clear bits
+    unsigned int run = 0, longest = 0, longest_end = 0;
+    for (unsigned int k = 1; k <= size; k++) {
+        const unsigned int i = (set+k)%size;
+        if (is_set(i)) {
+            if (run>longest) {
+                longest = run;
+                longest_end = i;
+            }
+            run = 0;
+        } else {
+            run++;
+        }
+    }
+    span_start = (longest>0) ? longest_end : 0;
+    span_count = size-longest;
+    return true;
+}
 /**
  * World::World()
  *
@@ -80,11 +411,18 @@ World::World(const unsigned int square_size): World(square_size,square_size) {
  *      The height of the world.
  */
 
-World::World(const unsigned int width, const unsigned int height){
+World::World(const unsigned int width, const unsigned int height): kernel(Kernel::best()),
+    lookup_table(Kernel::get_lookup_table(rule)), last_topology(Topology::Type::DEAD), engine(Engine::STEP),
+    state_engine(Engine::STEP), universe_x(0), universe_y(0), state_exported(false), generation(0),
+    history(HISTORY_SIZE), history_generations(HISTORY_SIZE), history_next(HISTORY_SIZE),
+    history_previous(HISTORY_SIZE), history_buckets(HISTORY_BUCKETS), history_size(0), unbounded(false),
+    block_depth(BLOCK_DEPTH), origin_x(0), origin_y(0) {
     //calls grid::resize() to pad current state with dead cells
     current_state.resize(width,height);
     //copies current_state for initialization
     this->next_state = current_state;
+    mark_all_changed();
+    reset_history();
 }
 
 /**
@@ -107,10 +445,91 @@ World::World(const unsigned int width, const unsigned int height){
  *      The state of the constructed world.
  */
 
-World::World(const Grid initial_state) {
-    //sets both grids to be grid parameter
-    this->current_state = initial_state;
-    this->next_state = initial_state;
+World::World(const Grid &initial_state): World(Grid(initial_state)) {
+}
+
+/**
+ * World::World(initial_state)
+ *
+ * Construct a world by taking over the cells of a grid that is no longer needed, without copying them.
+ *
+ * @example
+ *
+ *      // Make a world straight from a loaded file
+ *      World world(Zoo::load_ascii("glider.gol"));
+ *
+ *      // Or hand over a grid made earlier, which is left empty
+ *      Grid grid(16, 9);
+ *      World other_world(std::move(grid));
+ *
+ * @param initial_state
+ *      The state of the constructed world, moved from.
+ */
+
+World::World(Grid &&initial_state): current_state(std::move(initial_state)), kernel(Kernel::best()),
+    lookup_table(Kernel::get_lookup_table(rule)), last_topology(Topology::Type::DEAD), engine(Engine::STEP),
+    state_engine(Engine::STEP), universe_x(0), universe_y(0), state_exported(false), generation(0),
+    history(HISTORY_SIZE), history_generations(HISTORY_SIZE), history_next(HISTORY_SIZE),
+    history_previous(HISTORY_SIZE), history_buckets(HISTORY_BUCKETS), history_size(0), unbounded(false),
+    block_depth(BLOCK_DEPTH), origin_x(0), origin_y(0) {
+    //next state is overwritten by the first step so only needs to match in size
+    next_state = Grid(current_state.get_width(), current_state.get_height());
+    mark_all_changed();
+    reset_history();
+}
+
+/**
+ * World::World(initial_state)
+ *
+ * Construct a world from a view of a grid, such as a crop or rotation of a pattern.
+ * The view is materialized once, straight into the state of the world.
+ *
+ * @example
+ *
+ *      // Start a world from the top left quarter of a grid, mirrored
+ *      World world(GridView(grid).crop(0, 0, 32, 32).reflect_horizontal());
+ *
+ * @param initial_state
+ *      The view holding the state of the constructed world.
+ */
+
+World::World(const GridView &initial_state): World(initial_state.get_grid()) {
+}
+
+/**
+ * World::World(initial_state)
+ *
+ * Construct a world stepped by the sparse engine, World::Engine::SPARSE, taking over the chunks of a sparse grid
+ * and its rule. The grids are never made while the sparse engine holds the state, so a world of any size
+ * takes memory only for the chunks of its alive cells.
+ *
+ * @example
+ *
+ *      // Make a 1,000,000 x 1,000,000 world with a glider near the middle, without a grid of that size
+ *      SparseGrid grid(1000000);
+ *      grid.set(500001, 500000, Cell::ALIVE);
+ *      grid.set(500002, 500001, Cell::ALIVE);
+ *      grid.set(500000, 500002, Cell::ALIVE);
+ *      grid.set(500001, 500002, Cell::ALIVE);
+ *      grid.set(500002, 500002, Cell::ALIVE);
+ *      World world(std::move(grid));
+ *
+ *      // Advance it with dead edges or as a torus, still without the grids
+ *      world.advance(1000);
+ *
+ * @param initial_state
+ *      The state of the constructed world, moved from.
+ */
+
+World::World(SparseGrid &&initial_state): kernel(Kernel::best()), rule(initial_state.get_rule()),
+    lookup_table(Kernel::get_lookup_table(rule)), last_topology(Topology::Type::DEAD), engine(Engine::SPARSE),
+    state_engine(Engine::SPARSE), sparse_state(std::move(initial_state)), universe_x(0), universe_y(0),
+    state_exported(false), generation(0), history(HISTORY_SIZE), history_generations(HISTORY_SIZE),
+    history_next(HISTORY_SIZE), history_previous(HISTORY_SIZE), history_buckets(HISTORY_BUCKETS), history_size(0),
+    unbounded(false), block_depth(BLOCK_DEPTH), origin_x(0), origin_y(0) {
+    //the grids stay empty, the tiles, bounds and hash are found from the chunks
+    mark_all_changed();
+    reset_history();
 }
 
 World::~World() {
@@ -141,7 +560,7 @@ World::~World() {
  */
 
 unsigned int World::get_width() const {
-    return current_state.get_width();
+    return (state_engine==Engine::SPARSE) ? sparse_state.get_width() : current_state.get_width();
 }
 
 /**
@@ -169,7 +588,7 @@ unsigned int World::get_width() const {
  */
 
 unsigned int World::get_height() const {
-    return current_state.get_height();
+    return (state_engine==Engine::SPARSE) ? sparse_state.get_height() : current_state.get_height();
 }
 
 /**
@@ -196,8 +615,8 @@ unsigned int World::get_height() const {
  *      The number of total cells.
  */
 
-unsigned int World::get_total_cells() const{
-    return current_state.get_total_cells();
+std::uint64_t World::get_total_cells() const{
+    return (std::uint64_t) get_width()*get_height();
 }
 
 /**
@@ -224,8 +643,8 @@ unsigned int World::get_total_cells() const{
  *      The number of alive cells.
  */
 
-unsigned int World::get_alive_cells() const{
-    return current_state.get_alive_cells();
+std::uint64_t World::get_alive_cells() const{
+    return (state_engine==Engine::SPARSE) ? sparse_state.get_alive_cells() : current_state.get_alive_cells();
 }
 
 /**
@@ -252,8 +671,8 @@ unsigned int World::get_alive_cells() const{
  *      The number of dead cells.
  */
 
-unsigned int World::get_dead_cells() const{
-    return current_state.get_dead_cells();
+std::uint64_t World::get_dead_cells() const{
+    return get_total_cells()-get_alive_cells();
 }
 
 /**
@@ -262,6 +681,8 @@ unsigned int World::get_dead_cells() const{
  * Return a read-only reference to the current state
  * The function should be callable from a constant context.
  * The function should not invoke a copy the current state.
+ * While the sparse engine holds the state, a grid is made from its chunks on the first call after each
+ * run of steps, and is let go by the next step, so the reference is only valid until the world next changes.
  *
  * @example
  *
@@ -282,195 +703,2054 @@ unsigned int World::get_dead_cells() const{
  */
 
 const Grid &World::get_state() const {
+    //the sparse engine keeps the only copy of the cells unless the world is mapped
+    if (state_engine==Engine::SPARSE && !is_mapped()) {
+        if (!state_exported) {
+            exported_state = sparse_state.get_grid();
+            state_exported = true;
+        }
+        return exported_state;
+    }
     return current_state;
 }
 
 /**
- * World::resize(square_size)
- *
- * Resize the current state grid in to the new square width and height.
+ * World::get_state(x0, y0)
  *
- * The content of the current state grid should be preserved within the kept region.
- * The values in the next state grid do not need to be preserved, allowing an easy optimization.
+ * Returns a read-only reference to the current state, along with the coordinate of its top left cell
+ * on the plane. The origin only moves in an unbounded world, where the grids are regrown and trimmed
+ * around the alive cells, and starts at 0,0.
+ * The function should be callable from a constant context.
  *
  * @example
  *
- *      // Make a grid
- *      World world(4, 4);
+ *      // Make an unbounded world holding a glider and let it fly
+ *      World world(Zoo::glider());
+ *      world.set_unbounded(true);
+ *      world.advance(1000);
  *
- *      // Resize the world to be 8x8
- *      world.resize(8);
+ *      // Find where the glider has got to
+ *      std::int64_t x0, y0;
+ *      const Grid &state = world.get_state(x0, y0);
  *
- * @param square_size
- *      The new edge size for both the width and height of the grid.
+ * @param x0
+ *      Set to the plane x coordinate of the left column of the state.
+ *
+ * @param y0
+ *      Set to the plane y coordinate of the top row of the state.
+ *
+ * @return
+ *      A reference to the current state.
  */
 
-void World::resize(unsigned int square_size){
-    //uses resize function below to remove duplication of code
-    resize(square_size,square_size);
+const Grid &World::get_state(std::int64_t &x0, std::int64_t &y0) const {
+    x0 = origin_x;
+    y0 = origin_y;
+    return get_state();
 }
 
 /**
- * World::resize(new_width, new_height)
+ * World::get_bounds(x0, y0, x1, y1)
  *
- * Resize the current state grid in to the new width and height.
+ * Gets the bounding box of the alive cells of the current state, which is kept up to date by every step,
+ * so it can be read every generation without scanning the grid.
+ * The function should be callable from a constant context.
  *
- * The content of the current state grid should be preserved within the kept region.
- * The values in the next state grid do not need to be preserved, allowing an easy optimization.
+ * On a torus the box may wrap around an edge, when x1 is greater than the width or y1 greater than the
+ * height, and the cells of the box are taken modulo the size of the world.
  *
  * @example
  *
- *      // Make a grid
- *      World world(4, 4);
+ *      // Draw only the part of a large world holding alive cells
+ *      unsigned int x0, y0, x1, y1;
+ *      if (world.get_bounds(x0, y0, x1, y1)) {
+ *          std::cout << GridView(world.get_state()).crop(x0, y0, x1, y1) << std::endl;
+ *      }
  *
- *      // Resize the world to be 2x8
- *      world.resize(2, 8);
+ * @param x0
+ *      Set to the x coordinate of the left edge of the box (inclusive).
  *
- * @param new_width
- *      The new width for the grid.
+ * @param y0
+ *      Set to the y coordinate of the top edge of the box (inclusive).
  *
- * @param new_height
- *      The new height for the grid.
+ * @param x1
+ *      Set to the x coordinate of the right edge of the box (exclusive).
+ *
+ * @param y1
+ *      Set to the y coordinate of the bottom edge of the box (exclusive).
+ *
+ * @return
+ *      True if any cell is alive, false if the world is empty and the box was not set.
  */
 
-void World::resize(const unsigned int new_width, const unsigned int new_height){
-    //uses grid resize to remove duplication of code
-    current_state.resize(new_width,new_height);
+bool World::get_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const {
+    if (bounds.width==0 || bounds.height==0) {
+        return false;
+    }
+    x0 = bounds.x;
+    y0 = bounds.y;
+    x1 = bounds.x+bounds.width;
+    y1 = bounds.y+bounds.height;
+    return true;
 }
 
 /**
- * World::count_neighbours(x, y, toroidal)
+ * World::create_mapped(path)
  *
- * Private helper function to count the number of alive neighbours of a cell.
- * The function should not be visible from outside the World class.
+ * Moves the world into a new memory mapped file, replacing any file at the path, and keeps stepping it there.
+ * Both grids are kept in the file, so the world can be larger than RAM and can be reopened later
+ * with World::open_mapped(path).
  *
- * Neighbours are considered within the 3x3 square centred around the cell at x,y in the current state grid.
- * Ignore the centre coordinate, a cell is not its own neighbour.
- * Attempt to keep the logic as simple, expressive, and readable as possible.
+ * @example
  *
- * If toroidal = false then skip any neighbours that would be outside of the grid,
- * this assumes the grid is Cell::DEAD outside its bounds.
+ *      // Make a world and move it into a file
+ *      World world(Zoo::glider());
+ *      world.resize(100000);
+ *      world.create_mapped("world.map");
  *
- * If toroidal = true then correctly wrap out of bounds coordinates to the opposite side of the grid.
+ *      // Each step is written straight to the file
+ *      world.advance(100);
  *
- * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
- * while Grid is more generic to any 2D grid based cellular automaton.
+ * @param path
+ *      The path of the file to create.
  *
- * @param x
- *      The x coordinate of the centre of the neighbourhood.
+ * @throws
+ *      std::runtime_error or sub-class if the file cannot be created or mapped.
+ */
+
+void World::create_mapped(const std::string path) {
+    release_engine_state();
+    const std::size_t region = Grid::get_mapped_size(get_width(), get_height());
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path, MAPPED_HEADER_SIZE+2*region);
+    MappedHeader *header = (MappedHeader*) file->get_address();
+    std::memcpy(header->magic, MAPPED_MAGIC, sizeof(MAPPED_MAGIC));
+    header->width = get_width();
+    header->height = get_height();
+    //the next state starts dead, every tile is stepped before it is read
+    Grid mapped_current(file, MAPPED_HEADER_SIZE, get_width(), get_height());
+    Grid mapped_next(file, MAPPED_HEADER_SIZE+region, get_width(), get_height());
+    Grid state = std::move(current_state);
+    current_state = std::move(mapped_current);
+    replace_state(std::move(state));
+    next_state = std::move(mapped_next);
+    mapping = file;
+    mark_all_changed();
+    write_header();
+}
+
+/**
+ * World::open_mapped(path)
  *
- * @param y
- *      The y coordinate of the centre of the neighbourhood.
+ * Replaces the world with one kept in a memory mapped file by World::create_mapped(path), at the
+ * generation it was left at, and keeps stepping it there.
+ * Only the header is read, the cells are paged in by the operating system as they are used.
  *
- * @param toroidal
- *      If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom.
+ * @example
+ *
+ *      // Carry on stepping a world saved earlier
+ *      World world;
+ *      world.open_mapped("world.map");
+ *      world.advance(100);
+ *
+ * @param path
+ *      The path of the file to open.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the file cannot be opened or mapped, or does not hold a world.
+ */
+
+void World::open_mapped(const std::string path) {
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+    const MappedHeader *header = (const MappedHeader*) file->get_address();
+    if (file->get_size()<MAPPED_HEADER_SIZE || std::memcmp(header->magic, MAPPED_MAGIC, sizeof(MAPPED_MAGIC))!=0
+        || header->current>1) {
+        throw std::runtime_error("World::open_mapped " + path + " is not a mapped world.");
+    }
+    const std::size_t region = Grid::get_mapped_size(header->width, header->height);
+    if (file->get_size()!=MAPPED_HEADER_SIZE+2*region) {
+        throw std::runtime_error("World::open_mapped " + path + " has the wrong size.");
+    }
+    Grid mapped_current(file, MAPPED_HEADER_SIZE+header->current*region, header->width, header->height);
+    Grid mapped_next(file, MAPPED_HEADER_SIZE+(1-header->current)*region, header->width, header->height);
+    mapped_current.set_alive_cells(header->alive_cells[header->current]);
+    mapped_next.set_alive_cells(header->alive_cells[1-header->current]);
+    release_engine_state();
+    current_state = std::move(mapped_current);
+    next_state = std::move(mapped_next);
+    mapping = file;
+    generation = header->generation;
+    state_hash = header->state_hash;
+    origin_x = 0;
+    origin_y = 0;
+    mark_all_changed();
+    clear_history();
+}
+
+/**
+ * World::is_mapped()
+ *
+ * Checks if the world is kept in a memory mapped file.
+ * The function should be callable from a constant context.
  *
  * @return
- *      Returns the number of alive neighbours.
+ *      True if both grids of the world are in a mapped file.
  */
 
-unsigned int World::count_neighbours(const int x, const int y, const bool toroidal) {
-    unsigned int num_neighbours = 0;
-    int new_x, new_y;
-    //loops through -1 to +1 around cell x,y parameter
-    for (int column=(y-1); column<=(y+1); column++) {
-        for (int row=(x-1); row<=(x+1); row++) {
-            new_x = row;
-            new_y = column;
-
-            //if toroidal and out of bounds then wrap around the grid accordingly
-            if (toroidal) {
-                if (row<=-1) {
-                    new_x=get_width()+row;
-                } else if (row>=(int) get_width()) {
-                    new_x=0+(row-get_width());
-                }
-                if (column<=-1) {
-                    new_y=get_height()+column;
-                } else if (column>=(int) get_height()) {
-                    new_y=0+(column-get_height());
-                }
-            }
+bool World::is_mapped() const {
+    return mapping!=nullptr;
+}
 
-            //if not toroidal and out of bounds then set to x,y parameter as a cell cannot be
-            //its own neighbour
-            if (!toroidal 
-            && (row<=-1 || row>=(int) get_width() || column<=-1 || column>=(int) get_height())) {
-                new_x = x;
-                new_y = y;
-            } 
-            
-            //if new x,y is not equal to x,y parameter (cell cannot be its own neighbour) and
-            //cell at x,y is alive then increment number of neighbours
-            if (!(new_x==x && new_y==y) && current_state.get(new_x,new_y)==Cell::ALIVE) {
-                num_neighbours++;
-            }
-        }
-    }
-    return num_neighbours;
+/**
+ * World::get_generation()
+ *
+ * Gets the number of generations the world has advanced since it was constructed.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The current generation.
+ */
+
+std::uint64_t World::get_generation() const {
+    return generation;
 }
 
 /**
- * World::step(toroidal)
+ * World::get_period()
  *
- * Take one step in Conway's Game of Life.
+ * Gets the period of the cycle the world has been found to be in, if any.
+ * The function should be callable from a constant context.
  *
- * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
- * Should be implemented by invoking World::count_neighbours(x, y, toroidal).
- * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
- * Try and boil the logic down to the fewest and most simple conditional statements.
+ * @example
  *
- * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
- *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
- *      - Any live cell with two or three live neighbours lives on to the next generation.
- *      - Any live cell with more than three live neighbours dies, as if by overpopulation.
- *      - Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+ *      // Make a world holding a blinker
+ *      World world(5);
+ *      ...
  *
- * @param toroidal
- *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom. Defaults to false.
+ *      // Advance it, the cycle is found within a few generations and the rest are skipped
+ *      world.advance(1000000);
+ *      std::cout << world.get_period() << std::endl; // 2
+ *
+ * @return
+ *      The period of the cycle, 1 for a still life, or 0 if no cycle has been found.
  */
 
-void World::step(const bool toroidal) {
-    //loops through x,y of current grid
-    for (unsigned int y = 0; y < get_height(); y++) {
-        for (unsigned int x = 0; x < get_width(); x++) {
-            //calculates number of neighbours a cell has
-            unsigned int num_neighbours = count_neighbours(x,y,toroidal);
-            //if 2 neighbours and alive or 3 neighbours then
-            if ((num_neighbours==2 && current_state.get(x,y)==Cell::ALIVE) 
-                || (num_neighbours==3)) {
-                //sets x,y of next state alive 
-                next_state.set(x,y,Cell::ALIVE);
-            //else
-            } else {
-                //sets x,y of next state dead
-                next_state.set(x,y,Cell::DEAD);
-            }
-        }
-    }
-    //swaps current and next state in O(1) time, without invoking a copy
-    std::swap(current_state,next_state);
+std::uint64_t World::get_period() const {
+    return period;
 }
 
 /**
- * World::advance(steps, toroidal)
+ * World::get_cycle_start()
  *
- * Advance multiple steps in the Game of Life.
- * Should be implemented by invoking World::step(toroidal).
+ * Gets the earliest remembered generation from which the world repeats with World::get_period().
+ * The function should be callable from a constant context.
  *
- * @param steps
- *      The number of steps to advance the world forward.
+ * @return
+ *      The generation the cycle started at, only meaningful if World::get_period() is not 0.
+ */
+
+std::uint64_t World::get_cycle_start() const {
+    return cycle_start;
+}
+
+/**
+ * World::get_kernel()
  *
- * @param toroidal
- *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom. Defaults to false.
+ * Gets the kernel used to step the world.
+ * The function should be callable from a constant context.
+ *
+ * @example
+ *
+ *      // Make a world
+ *      World world(4, 4);
+ *
+ *      // Print the name of the kernel the world steps with
+ *      std::cout << Kernel::get_name(world.get_kernel()) << std::endl;
+ *
+ * @return
+ *      The kernel in use, Kernel::best() unless changed by World::set_kernel.
  */
 
-void World::advance(const int steps, const bool toroidal) {
-    //loops through number of steps parameter
-    for (int i=0; i<steps; i++) {
-        step(toroidal);
-    }
-}
\ No newline at end of file
+Kernel::Type World::get_kernel() const {
+    return kernel;
+}
+
+/**
+ * World::set_kernel(type)
+ *
+ * Sets the kernel used to step the world. Every kernel gives the same result.
+ *
+ * @example
+ *
+ *      // Make a world
+ *      World world(4, 4);
+ *
+ *      // Step the world one cell at a time using World::count_neighbours
+ *      world.set_kernel(Kernel::Type::REFERENCE);
+ *
+ * @param type
+ *      The kernel to use.
+ *
+ * @throws
+ *      std::invalid_argument if the kernel is not supported by the CPU.
+ */
+
+void World::set_kernel(const Kernel::Type type) {
+    if (!Kernel::is_supported(type)) {
+        throw std::invalid_argument("World::set_kernel kernel not supported by this CPU.");
+    }
+    kernel = type;
+}
+
+/**
+ * World::get_rule()
+ *
+ * Gets the rule the world is stepped with.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The rule in use, Rule::conway() unless changed by World::set_rule.
+ */
+
+const Rule &World::get_rule() const {
+    return rule;
+}
+
+/**
+ * World::set_rule(rule)
+ *
+ * Sets the Life-like rule the world is stepped with, by every kernel and engine.
+ * Tiles that were still and states that repeated under the old rule may not under the new one,
+ * so both are forgotten. The lookup table of the rule is found here, once, for Kernel::Type::LOOKUP.
+ *
+ * @example
+ *
+ *      // Make a world following HighLife
+ *      World world(Zoo::r_pentomino());
+ *      world.set_rule(Rule("B36/S23"));
+ *
+ * @param rule
+ *      The rule to use.
+ */
+
+void World::set_rule(const Rule &rule) {
+    if (rule==this->rule) {
+        return;
+    }
+    this->rule = rule;
+    lookup_table = Kernel::get_lookup_table(rule);
+    //the sparse engine carries on from its chunks under the new rule, the event driven engine counts again,
+    //and the universe forgets the futures it found under the old rule
+    if (state_engine==Engine::SPARSE) {
+        sparse_state.set_rule(rule);
+    } else if (state_engine==Engine::EVENT) {
+        event_state.set_rule(rule);
+    } else if (state_engine==Engine::HASHLIFE) {
+        universe->set_rule(rule);
+    }
+    mark_all_changed();
+    reset_history();
+}
+
+/**
+ * World::get_engine()
+ *
+ * Gets the engine used to advance the world.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The engine in use, World::Engine::STEP unless changed by World::set_engine.
+ */
+
+World::Engine World::get_engine() const {
+    return engine;
+}
+
+/**
+ * World::set_engine(engine)
+ *
+ * Sets the engine used to advance the world.
+ *      - World::Engine::STEP steps one generation at a time with the word level kernels.
+ *      - World::Engine::HASHLIFE jumps through time with a memoized quadtree, in time that grows with
+ *        the complexity of the pattern rather than the number of generations. Its plane is unbounded,
+ *        so it only advances worlds made unbounded by World::set_unbounded with dead edges. Other worlds,
+ *        and single generations, are stepped as by World::Engine::STEP.
+ *      - World::Engine::SPARSE steps one generation at a time, but only the 64x64 chunks near alive
+ *        cells, in time that grows with the population rather than the area.
+ *      - World::Engine::EVENT steps one generation at a time, but only the cells next to the cells that
+ *        changed in the last generation, in time that grows with the births and deaths of each generation.
+ * Changing the engine hands the state held by the old engine back to the grids.
+ *
+ * @example
+ *
+ *      // Make an unbounded world holding an r-pentomino
+ *      World world(Zoo::r_pentomino());
+ *      world.set_unbounded(true);
+ *
+ *      // Advance it a billion generations
+ *      world.set_engine(World::Engine::HASHLIFE);
+ *      world.advance(1000000000);
+ *
+ * @param engine
+ *      The engine to use.
+ */
+
+void World::set_engine(const Engine engine) {
+    if (engine!=this->engine) {
+        release_engine_state();
+    }
+    this->engine = engine;
+}
+
+/**
+ * World::get_threads()
+ *
+ * Gets the number of threads each step is split across.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The number of threads, 1 unless changed by World::set_threads.
+ */
+
+unsigned int World::get_threads() const {
+    return pool ? pool->get_num_threads() : 1;
+}
+
+/**
+ * World::set_threads(num_threads)
+ *
+ * Sets the number of threads each step is split across. The threads are started here and kept
+ * for the lifetime of the world, rather than being started on each step.
+ *
+ * @example
+ *
+ *      // Make a world
+ *      World world(4096, 4096);
+ *
+ *      // Step the world on 8 threads
+ *      world.set_threads(8);
+ *      world.advance(100);
+ *
+ * @param num_threads
+ *      The number of threads to use, 1 to step on the calling thread only.
+ *
+ * @throws
+ *      std::invalid_argument if num_threads is 0.
+ */
+
+void World::set_threads(const unsigned int num_threads) {
+    if (num_threads==0) {
+        throw std::invalid_argument("World::set_threads needs at least 1 thread.");
+    }
+    if (num_threads==1) {
+        pool.reset();
+    } else if (num_threads!=get_threads()) {
+        pool = std::make_shared<ThreadPool>(num_threads);
+    }
+    size_bands();
+}
+
+/**
+ * World::is_unbounded()
+ *
+ * Checks if the world grows and trims its grids to follow its alive cells across an unbounded plane.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      True if the world is unbounded.
+ */
+
+bool World::is_unbounded() const {
+    return unbounded;
+}
+
+/**
+ * World::set_unbounded(enabled)
+ *
+ * Sets whether the world stands in for an unbounded plane. While enabled, steps with dead edges
+ * regrow the grids before any alive cell could leave them, and trim margins that have grown too large.
+ * Steps with other topologies use the grid as it is. Disabling it keeps the grids as they are.
+ *
+ * @example
+ *
+ *      // Let a glider fly as far as it likes
+ *      World world(Zoo::glider());
+ *      world.set_unbounded(true);
+ *      world.advance(10000);
+ *
+ * @param enabled
+ *      True to make the world unbounded, false to keep its size fixed.
+ */
+
+void World::set_unbounded(const bool enabled) {
+    unbounded = enabled;
+}
+
+/**
+ * World::get_block_depth()
+ *
+ * Gets the number of generations World::advance steps each block of rows at once, when the world
+ * is too large to stay in cache between generations.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The block depth, World::BLOCK_DEPTH unless changed by World::set_block_depth.
+ */
+
+unsigned int World::get_block_depth() const {
+    return block_depth;
+}
+
+/**
+ * World::set_block_depth(depth)
+ *
+ * Sets the number of generations World::advance steps each block of rows at once. Deeper blocks read
+ * the grid from memory less often, but step more extra rows around each block.
+ *
+ * @example
+ *
+ *      // Advance a large world 16 generations per pass over memory
+ *      World world(16384, 16384);
+ *      world.set_block_depth(16);
+ *      world.advance(1000);
+ *
+ *      // Or step every generation over the whole world
+ *      world.set_block_depth(1);
+ *
+ * @param depth
+ *      The number of generations per block, 0 or 1 to step one generation at a time.
+ */
+
+void World::set_block_depth(const unsigned int depth) {
+    block_depth = depth;
+    size_bands();
+}
+
+/**
+ * World::resize(square_size)
+ *
+ * Resize the current state grid in to the new square width and height.
+ *
+ * The content of the current state grid should be preserved within the kept region.
+ * The values in the next state grid do not need to be preserved, allowing an easy optimization.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      World world(4, 4);
+ *
+ *      // Resize the world to be 8x8
+ *      world.resize(8);
+ *
+ * @param square_size
+ *      The new edge size for both the width and height of the grid.
+ */
+
+void World::resize(unsigned int square_size){
+    //uses resize function below to remove duplication of code
+    resize(square_size,square_size);
+}
+
+/**
+ * World::resize(new_width, new_height)
+ *
+ * Resize the current state grid in to the new width and height.
+ *
+ * The content of the current state grid should be preserved within the kept region.
+ * The values in the next state grid do not need to be preserved, allowing an easy optimization.
+ * Both grids resize in place within their capacity, see Grid::resize, so a world that keeps growing
+ * only moves its cells when it outgrows the room it has.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      World world(4, 4);
+ *
+ *      // Resize the world to be 2x8
+ *      world.resize(2, 8);
+ *
+ * @param new_width
+ *      The new width for the grid.
+ *
+ * @param new_height
+ *      The new height for the grid.
+ */
+
+void World::resize(const unsigned int new_width, const unsigned int new_height){
+    release_engine_state();
+    //uses grid resize to remove duplication of code
+    current_state.resize(new_width,new_height);
+    //next state is overwritten by the next step so only needs to match in size
+    next_state.resize(new_width,new_height);
+    mark_all_changed();
+    reset_history();
+}
+
+/**
+ * World::get_tiles_x()
+ *
+ * Private helper function to get the number of columns of tiles, one per storage word of a row.
+ *
+ * @return
+ *      The number of tiles across the world.
+ */
+
+unsigned int World::get_tiles_x() const {
+    return current_state.get_words_per_row();
+}
+
+/**
+ * World::get_tiles_y()
+ *
+ * Private helper function to get the number of rows of tiles, the last of which may be partly filled.
+ *
+ * @return
+ *      The number of tiles down the world.
+ */
+
+unsigned int World::get_tiles_y() const {
+    return (get_height()+TILE_ROWS-1)/TILE_ROWS;
+}
+
+/**
+ * World::get_active_tiles(ty, topology, column, active)
+ *
+ * Private helper function to find which tiles of a tile row may change in the next step, which is
+ * when the tile or any of the 8 tiles around it changed in the last step.
+ *
+ * @param ty
+ *      The tile row.
+ *
+ * @param topology
+ *      The edges of the world. Tiles on edges that wrap border the tiles on the opposite edges, and
+ *      tiles on reflecting edges only border their own mirror images.
+ *
+ * @param column
+ *      Scratch space for one flag per tile of the row, reused between calls.
+ *
+ * @param active
+ *      Filled with one flag per tile of the row, set if the tile needs to be stepped.
+ */
+
+void World::get_active_tiles(const unsigned int ty, const Topology::Type topology, unsigned char *column,
+                             unsigned char *active) const {
+    const unsigned int tiles_x = get_tiles_x(), tiles_y = get_tiles_y();
+    const bool wrap_x = Topology::wraps_x(topology), wrap_y = Topology::wraps_y(topology);
+    //combine the tile row with the rows above and below, wrapping them or skipping them off the edges
+    std::fill(column, column+tiles_x, 0);
+    for (int row = (int) ty-1; row <= (int) ty+1; row++) {
+        int new_row = row;
+        if (wrap_y) {
+            new_row = (row+tiles_y)%tiles_y;
+        } else if (row<0 || row>=(int) tiles_y) {
+            continue;
+        }
+        const unsigned char *changed = &changed_tiles[(std::size_t) new_row*tiles_x];
+        for (unsigned int tx = 0; tx < tiles_x; tx++) {
+            column[tx] |= changed[tx];
+        }
+    }
+    //then combine each column with its left and right neighbours in the same way
+    for (unsigned int tx = 0; tx < tiles_x; tx++) {
+        active[tx] = column[tx]
+            | ((tx>0) ? column[tx-1] : (wrap_x ? column[tiles_x-1] : 0))
+            | ((tx+1<tiles_x) ? column[tx+1] : (wrap_x ? column[0] : 0));
+    }
+}
+
+/**
+ * World::mark_all_changed()
+ *
+ * Private helper function to flag every tile as changed, so the next step recomputes the whole world,
+ * and to find the bounding box of the alive cells from scratch.
+ * The next state may hold anything, so it is taken to have alive cells anywhere.
+ * Called whenever the current state is replaced rather than stepped, which also lets go of any grid
+ * exported from the sparse engine, as it no longer holds the state.
+ */
+
+void World::mark_all_changed() {
+    changed_tiles.assign((std::size_t) get_tiles_x()*get_tiles_y(), 1);
+    next_changed_tiles.assign((std::size_t) get_tiles_x()*get_tiles_y(), 1);
+    unsigned int x0, y0, x1, y1;
+    bounds = Bounds{0, 0, 0, 0};
+    if (find_bounds(x0, y0, x1, y1)) {
+        bounds = Bounds{x0, y0, x1-x0, y1-y0};
+    }
+    next_bounds = Bounds{0, 0, get_width(), get_height()};
+    exported_state = Grid();
+    state_exported = false;
+    size_bands();
+}
+
+/**
+ * World::size_bands()
+ *
+ * Private helper function to size the scratch space each band of a step or of a block works in, for the size
+ * of the world, the number of threads, and the block depth. Called whenever any of them changes, so neither
+ * World::step nor World::advance allocate.
+ */
+
+void World::size_bands() {
+    const unsigned int num_threads = get_threads();
+    const std::size_t words_per_row = current_state.get_words_per_row();
+    //two rows of tile flags per band, see World::get_active_tiles
+    band_tiles.assign((std::size_t) 2*num_threads*get_tiles_x(), 0);
+    band_hash_changes.assign(num_threads, 0);
+    band_alive_changes.assign(num_threads, 0);
+    live_rows.assign(get_tiles_y(), 0);
+    live_columns.assign((std::size_t) num_threads*words_per_row, 0);
+    //the two strip buffers of each band of a block, as large as the largest strip World::step_blocked makes
+    const std::size_t max_rows = (std::size_t) current_state.get_height()+2*block_depth;
+    const std::size_t strip_words = std::min<std::size_t>(std::max<std::size_t>(BLOCK_BYTES/(2*sizeof(std::uint64_t)),
+                                                                                4*block_depth*words_per_row),
+                                                          max_rows*words_per_row)+2*words_per_row;
+    block_buffers.assign(2*num_threads*strip_words, 0);
+    block_inside.assign(num_threads*max_rows, 0);
+    block_rows.assign(current_state.get_height(), 0);
+    block_starts.reserve(HISTORY_SIZE);
+}
+
+/**
+ * World::set_region(topology, margin)
+ *
+ * Private helper function to find the region the next steps need to visit, the bounding box of the
+ * alive cells grown by margin cells on every side, and flag the words of a row it covers.
+ *
+ * @param topology
+ *      The edges of the world. The region wraps around edges that wrap, and stops at the others.
+ *
+ * @param margin
+ *      The number of generations being stepped, as no cell is born further than that from the box.
+ */
+
+void World::set_region(const Topology::Type topology, const unsigned int margin) {
+    region = Bounds{0, 0, 0, 0};
+    if (bounds.width>0 && bounds.height>0) {
+        grow_span(bounds.x, bounds.width, margin, get_width(), Topology::wraps_x(topology), region.x, region.width);
+        grow_span(bounds.y, bounds.height, margin, get_height(), Topology::wraps_y(topology), region.y, region.height);
+    }
+    region_words.assign(current_state.get_words_per_row(), 0);
+    unsigned int pieces[2][2];
+    const unsigned int num_pieces = get_word_pieces(region.x, region.width, get_width(), pieces);
+    for (unsigned int p = 0; p < num_pieces; p++) {
+        for (unsigned int i = pieces[p][0]; i < pieces[p][1]; i++) {
+            region_words[i] = 1;
+        }
+    }
+}
+
+/**
+ * World::clear_outside_region()
+ *
+ * Private helper function to kill the cells of the next state, left from the generation before last,
+ * that are outside the region the next step visits, so the next state is dead wherever it is not written.
+ * Only the bounding box of the next state is visited.
+ */
+
+void World::clear_outside_region() {
+    unsigned int row_pieces[2][2], word_pieces[2][2];
+    const unsigned int num_row_pieces = get_pieces(next_bounds.y, next_bounds.height, get_height(), row_pieces);
+    const unsigned int num_word_pieces = (next_bounds.height>0)
+        ? get_word_pieces(next_bounds.x, next_bounds.width, get_width(), word_pieces) : 0;
+    for (unsigned int rp = 0; rp < num_row_pieces; rp++) {
+        for (unsigned int y = row_pieces[rp][0]; y < row_pieces[rp][1]; y++) {
+            //rows in the region keep the words in the region, where inactive tiles are already correct
+            const bool in_region = (y+get_height()-region.y)%get_height()<region.height;
+            std::uint64_t *row = next_state.get_row_unchecked(y);
+            for (unsigned int wp = 0; wp < num_word_pieces; wp++) {
+                for (unsigned int i = word_pieces[wp][0]; i < word_pieces[wp][1]; i++) {
+                    if (!in_region || !region_words[i]) {
+                        row[i] = 0;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * World::update_bounds(topology, num_bands)
+ *
+ * Private helper function to find the bounding box of the next state from the rows and columns of alive
+ * cells found by the bands of a step, which can only be within the region, and keep the box of the
+ * current state as the box of the next state, ready for the grids to be swapped.
+ *
+ * @param topology
+ *      The edges of the world. The box may wrap around edges that wrap.
+ *
+ * @param num_bands
+ *      The number of bands the step was split into, each with its own columns in World::live_columns.
+ */
+
+void World::update_bounds(const Topology::Type topology, const unsigned int num_bands) {
+    next_bounds = bounds;
+    bounds = Bounds{0, 0, 0, 0};
+    const unsigned int words_per_row = current_state.get_words_per_row();
+    unsigned int pieces[2][2];
+    const unsigned int num_pieces = get_word_pieces(region.x, region.width, get_width(), pieces);
+    for (unsigned int band = 1; band < num_bands; band++) {
+        const std::uint64_t *columns = &live_columns[(std::size_t) band*words_per_row];
+        for (unsigned int p = 0; p < num_pieces; p++) {
+            for (unsigned int i = pieces[p][0]; i < pieces[p][1]; i++) {
+                live_columns[i] |= columns[i];
+            }
+        }
+    }
+    if (find_span(live_rows.data(), get_height(), region.y, region.height, Topology::wraps_y(topology),
+                  bounds.y, bounds.height)) {
+        find_span(live_columns.data(), get_width(), region.x, region.width, Topology::wraps_x(topology),
+                  bounds.x, bounds.width);
+    } else {
+        bounds.height = 0;
+    }
+}
+
+/**
+ * World::hash_state()
+ *
+ * Private helper function to hash every word of the current state from scratch.
+ * While the sparse engine holds the state only the words of its chunks are hashed, as dead words hash to 0.
+ *
+ * @return
+ *      The sum of the hashes of every word and its position.
+ */
+
+std::uint64_t World::hash_state() const {
+    std::uint64_t hash = 0;
+    if (state_engine==Engine::SPARSE) {
+        const std::uint64_t words_per_row = (get_width()+63)/64;
+        sparse_state.for_each_word([&](const unsigned int y, const unsigned int word_index, const std::uint64_t word) {
+            hash += hash_word(y*words_per_row+word_index, word);
+        });
+        return hash;
+    }
+    const unsigned int words_per_row = current_state.get_words_per_row();
+    for (unsigned int y = 0; y < get_height(); y++) {
+        const std::uint64_t *row = current_state.get_row_unchecked(y);
+        for (unsigned int i = 0; i < words_per_row; i++) {
+            hash += hash_word((std::uint64_t) y*words_per_row+i, row[i]);
+        }
+    }
+    return hash;
+}
+
+/**
+ * World::reset_history()
+ *
+ * Private helper function to forget every remembered generation and any cycle found, and start
+ * a new history from the current state. Called whenever the state is replaced or the topology changes.
+ */
+
+void World::reset_history() {
+    state_hash = hash_state();
+    clear_history();
+}
+
+/**
+ * World::clear_history()
+ *
+ * Private helper function to forget every remembered generation and any cycle found, and start
+ * a new history from the current state, whose hash is already known.
+ */
+
+void World::clear_history() {
+    history_size = 0;
+    std::fill(history_buckets.begin(), history_buckets.end(), HISTORY_SIZE);
+    cycle_candidate = Grid();
+    candidate_period = 0;
+    candidate_generation = 0;
+    candidate_start = 0;
+    period = 0;
+    cycle_start = 0;
+    remember_generation();
+    write_header();
+}
+
+/**
+ * World::remember_generation()
+ *
+ * Private helper function to add the hash of the current generation to the history,
+ * dropping the oldest generation once there are more than World::HISTORY_SIZE.
+ *
+ * Generation g is held in slot g % World::HISTORY_SIZE of the ring, and linked in at the head of the bucket
+ * for its hash, so each bucket runs from its newest generation to its oldest. Slots equal to
+ * World::HISTORY_SIZE mark the ends of the buckets.
+ */
+
+void World::remember_generation() {
+    const unsigned int slot = generation%HISTORY_SIZE;
+    //the oldest generation is in the slot being reused, and is the last in its bucket
+    if (history_size==HISTORY_SIZE) {
+        const unsigned int previous = history_previous[slot];
+        if (previous==HISTORY_SIZE) {
+            history_buckets[history[slot]%HISTORY_BUCKETS] = HISTORY_SIZE;
+        } else {
+            history_next[previous] = HISTORY_SIZE;
+        }
+    } else {
+        history_size++;
+    }
+    unsigned int &head = history_buckets[state_hash%HISTORY_BUCKETS];
+    history[slot] = state_hash;
+    history_generations[slot] = generation;
+    history_next[slot] = head;
+    history_previous[slot] = HISTORY_SIZE;
+    if (head!=HISTORY_SIZE) {
+        history_previous[head] = slot;
+    }
+    head = slot;
+}
+
+/**
+ * World::find_generation(hash)
+ *
+ * Private helper function to find the latest remembered generation with a hash.
+ * The function should be callable from a constant context.
+ *
+ * @param hash
+ *      The hash of the state to look for.
+ *
+ * @return
+ *      The slot of the ring holding the generation, or World::HISTORY_SIZE if no generation has the hash.
+ */
+
+unsigned int World::find_generation(const std::uint64_t hash) const {
+    unsigned int slot = history_buckets[hash%HISTORY_BUCKETS];
+    while (slot!=HISTORY_SIZE && history[slot]!=hash) {
+        slot = history_next[slot];
+    }
+    return slot;
+}
+
+/**
+ * World::record_generation()
+ *
+ * Private helper function called after each step to move on to the next generation and look for cycles.
+ *      - A pending candidate cycle is confirmed if the state matches the copy taken one period ago,
+ *        and dropped otherwise.
+ *      - If no cycle is known, a remembered generation with the same hash becomes a new candidate.
+ *        Its start is found by walking back through the history while generations one period apart match.
+ */
+
+void World::record_generation() {
+    generation++;
+    if (candidate_period!=0 && generation==candidate_generation+candidate_period) {
+        if (current_state==cycle_candidate) {
+            period = candidate_period;
+            cycle_start = candidate_start;
+        }
+        //the copy keeps its words for the next candidate, so finding one need not allocate
+        candidate_period = 0;
+    }
+    if (period==0 && candidate_period==0) {
+        const unsigned int match = find_generation(state_hash);
+        if (match!=HISTORY_SIZE) {
+            //history holds the generations [first, generation) before this one is remembered
+            const std::uint64_t first = generation-history_size;
+            const std::uint64_t new_period = generation-history_generations[match];
+            std::uint64_t start = history_generations[match];
+            while (start>first && history[(start-1)%HISTORY_SIZE]==history[(start-1+new_period)%HISTORY_SIZE]) {
+                start--;
+            }
+            cycle_candidate = current_state;
+            candidate_generation = generation;
+            candidate_period = new_period;
+            candidate_start = start;
+        }
+    }
+    remember_generation();
+    write_header();
+}
+
+/**
+ * World::replace_state(state)
+ *
+ * Private helper function to replace the current state with a grid computed elsewhere, as by HashLife.
+ * A mapped current state of the same size is overwritten in place so the world stays in its file.
+ *
+ * @param state
+ *      The new state, moved from.
+ */
+
+void World::replace_state(Grid &&state) {
+    if (!current_state.is_mapped() || state.get_width()!=get_width() || state.get_height()!=get_height()) {
+        current_state = std::move(state);
+        return;
+    }
+    for (unsigned int y = 0; y < get_height(); y++) {
+        const std::uint64_t *row = state.get_row_unchecked(y);
+        std::uint64_t *mapped_row = current_state.get_row_unchecked(y);
+        for (unsigned int i = 0; i < current_state.get_words_per_row(); i++) {
+            mapped_row[i] = row[i];
+        }
+    }
+    current_state.set_alive_cells(state.get_alive_cells());
+}
+
+/**
+ * World::write_header()
+ *
+ * Private helper function to record the generation and which region holds the current state in the
+ * header of the mapped file, if the world is mapped. If either grid has left the file since,
+ * the world stops using the file.
+ */
+
+void World::write_header() {
+    if (!mapping) {
+        return;
+    }
+    const std::size_t region = Grid::get_mapped_size(get_width(), get_height());
+    char *base = (char*) mapping->get_address()+MAPPED_HEADER_SIZE;
+    //the halo row above the first row is the start of a region
+    const char *current = (const char*) current_state.get_row_unchecked(-1);
+    const char *next = (const char*) next_state.get_row_unchecked(-1);
+    const bool mapped = current_state.is_mapped() && next_state.is_mapped()
+        && mapping->get_size()==MAPPED_HEADER_SIZE+2*region
+        && ((current==base && next==base+region) || (current==base+region && next==base));
+    if (!mapped) {
+        mapping.reset();
+        return;
+    }
+    MappedHeader *header = (MappedHeader*) mapping->get_address();
+    header->current = (current==base) ? 0 : 1;
+    header->generation = generation;
+    header->state_hash = state_hash;
+    header->alive_cells[header->current] = current_state.get_alive_cells();
+    header->alive_cells[1-header->current] = next_state.get_alive_cells();
+}
+
+/**
+ * World::find_bounds(x0, y0, x1, y1)
+ *
+ * Private helper function to find the smallest rectangle holding every alive cell, a word at a time,
+ * or a chunk at a time while the sparse engine holds the state.
+ *
+ * @return
+ *      True if any cell is alive, false if the world is empty and the bounds were not set.
+ */
+
+bool World::find_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const {
+    if (state_engine==Engine::SPARSE) {
+        return sparse_state.get_bounds(x0, y0, x1, y1);
+    }
+    if (current_state.get_alive_cells()==0) {
+        return false;
+    }
+    const unsigned int words_per_row = current_state.get_words_per_row();
+    //the union of every row, so the columns can be found once the rows have been scanned
+    std::vector<std::uint64_t> columns(words_per_row, 0);
+    bool found = false;
+    for (unsigned int y = 0; y < get_height(); y++) {
+        const std::uint64_t *row = current_state.get_row_unchecked(y);
+        std::uint64_t any = 0;
+        for (unsigned int i = 0; i < words_per_row; i++) {
+            columns[i] |= row[i];
+            any |= row[i];
+        }
+        if (any) {
+            if (!found) {
+                y0 = y;
+                found = true;
+            }
+            y1 = y+1;
+        }
+    }
+    unsigned int first = 0;
+    while (columns[first]==0) {
+        first++;
+    }
+    unsigned int last = words_per_row-1;
+    while (columns[last]==0) {
+        last--;
+    }
+    x0 = first*64+__builtin_ctzll(columns[first]);
+    x1 = last*64+64-__builtin_clzll(columns[last]);
+    return true;
+}
+
+/**
+ * World::fit_unbounded(trim)
+ *
+ * Private helper function to regrow the grids of an unbounded world around its alive cells, with a margin
+ * of dead cells on every side, if any edge cell is alive or, when trim is set, if any margin has grown
+ * to more than twice its size. An empty world is left as it is.
+ * While the sparse engine holds the state the alive cells are moved into a new SparseGrid, so the grids
+ * are not made, and a mapped world leaves its file as it would for any change of size.
+ *
+ * @param trim
+ *      If margins that have grown too large should be cut back.
+ */
+
+void World::fit_unbounded(const bool trim) {
+    unsigned int x0, y0, x1, y1;
+    if (!get_bounds(x0, y0, x1, y1)) {
+        return;
+    }
+    //a box left wrapping around the edges by steps that wrap is found again without wrapping
+    if (x1>get_width() || y1>get_height()) {
+        find_bounds(x0, y0, x1, y1);
+        bounds = Bounds{x0, y0, x1-x0, y1-y0};
+    }
+    //the step cannot reach past the edge unless an alive cell is on it
+    const bool grow = x0==0 || y0==0 || x1==get_width() || y1==get_height();
+    if (!grow && !trim) {
+        return;
+    }
+    const std::uint64_t margin_x = get_margin(x1-x0);
+    const std::uint64_t margin_y = get_margin(y1-y0);
+    if (!grow && x0<=2*margin_x && y0<=2*margin_y
+        && get_width()-x1<=2*margin_x && get_height()-y1<=2*margin_y) {
+        return;
+    }
+    if (state_engine==Engine::SPARSE) {
+        SparseGrid state(x1-x0+2*margin_x, y1-y0+2*margin_y);
+        state.set_rule(rule);
+        sparse_state.for_each_word([&](const unsigned int y, const unsigned int word_index, std::uint64_t word) {
+            while (word!=0) {
+                state.set(word_index*64+__builtin_ctzll(word)-x0+margin_x, y-y0+margin_y, Cell::ALIVE);
+                word &= word-1;
+            }
+        });
+        sparse_state = std::move(state);
+        mapping.reset();
+        current_state = Grid();
+        next_state = Grid();
+        origin_x += (std::int64_t) x0-(std::int64_t) margin_x;
+        origin_y += (std::int64_t) y0-(std::int64_t) margin_y;
+        mark_all_changed();
+        reset_history();
+        return;
+    }
+    release_engine_state();
+    Grid state(x1-x0+2*margin_x, y1-y0+2*margin_y);
+    state.merge(GridView(current_state).crop(x0, y0, x1, y1), margin_x, margin_y);
+    move_origin(std::move(state), (std::int64_t) x0-(std::int64_t) margin_x, (std::int64_t) y0-(std::int64_t) margin_y);
+}
+
+/**
+ * World::move_origin(state, dx, dy)
+ *
+ * Private helper function to replace the current state with a grid whose top left cell is dx,dy
+ * from the top left cell of the old state on the plane, resizing the next state to match.
+ *
+ * @param state
+ *      The new state, moved from.
+ *
+ * @param dx
+ *      The plane x coordinate of the new state relative to the old.
+ *
+ * @param dy
+ *      The plane y coordinate of the new state relative to the old.
+ */
+
+void World::move_origin(Grid &&state, const std::int64_t dx, const std::int64_t dy) {
+    replace_state(std::move(state));
+    next_state.resize(get_width(), get_height());
+    origin_x += dx;
+    origin_y += dy;
+    mark_all_changed();
+    reset_history();
+}
+
+/**
+ * World::is_degenerate(topology)
+ *
+ * Private helper function to check for a world only 1 cell across an axis that wraps, where cells wrap around
+ * to become their own neighbours. Only the per cell reference steps these, as it skips a cell's own position.
+ * A cell on a reflecting edge is its own mirror image, which every kernel counts, so those are not degenerate.
+ *
+ * @param topology
+ *      The edges the world is being stepped with.
+ *
+ * @return
+ *      True if the world is 1 cell wide and wraps left to right, or 1 cell high and wraps top to bottom.
+ */
+
+bool World::is_degenerate(const Topology::Type topology) const {
+    return (Topology::wraps_x(topology) && get_width()==1) || (Topology::wraps_y(topology) && get_height()==1);
+}
+
+/**
+ * World::is_engine_topology(topology)
+ *
+ * Private helper function to check if the engine of the world steps a topology itself. The sparse and event
+ * driven engines only know dead edges and a torus, and leave degenerate worlds to the per cell reference.
+ *
+ * @param topology
+ *      The edges the world is being stepped with.
+ *
+ * @return
+ *      True if the world is stepped by its sparse or event driven engine rather than the grids.
+ */
+
+bool World::is_engine_topology(const Topology::Type topology) const {
+    return (engine==Engine::SPARSE || engine==Engine::EVENT) && !is_degenerate(topology)
+        && (topology==Topology::Type::DEAD || topology==Topology::Type::TORUS);
+}
+
+/**
+ * World::release_engine_state()
+ *
+ * Private helper function to hand the state held by the sparse engine back to the grids, making them
+ * again unless the world is mapped, where they were kept up to date, or to let go of the EventGrid kept
+ * by the event driven engine or the universe kept by the HashLife engine, whose cells the grids already
+ * hold. Called before anything that reads or replaces the grids, such as a step with a topology the
+ * engine cannot take.
+ */
+
+void World::release_engine_state() {
+    if (state_engine==Engine::STEP) {
+        return;
+    }
+    if (state_engine==Engine::SPARSE && !is_mapped()) {
+        current_state = sparse_state.get_grid();
+        next_state = Grid(current_state.get_width(), current_state.get_height());
+    }
+    sparse_state = SparseGrid();
+    event_state = EventGrid();
+    universe.reset();
+    state_engine = Engine::STEP;
+    mark_all_changed();
+}
+
+/**
+ * World::count_neighbours<TOPOLOGY>(x, y)
+ *
+ * Private helper function to count the number of alive neighbours of a cell.
+ * The function should not be visible from outside the World class.
+ *
+ * Neighbours are considered within the 3x3 square centred around the cell at x,y in the current state grid.
+ * Ignore the centre coordinate, a cell is not its own neighbour.
+ * Attempt to keep the logic as simple, expressive, and readable as possible.
+ *
+ * Out of bounds coordinates are mapped by Topology::Edges for the topology:
+ *      - Topology::Type::DEAD skips any neighbours that would be outside of the grid,
+ *        this assumes the grid is Cell::DEAD outside its bounds.
+ *      - Topology::Type::TORUS wraps out of bounds coordinates to the opposite side of the grid.
+ *      - Topology::Type::CYLINDER wraps the x coordinate only, and skips neighbours above or below the grid.
+ *      - Topology::Type::REFLECT reads the cell on the edge for a coordinate just beyond it.
+ * A cell wrapped around onto its own position is still not its own neighbour, but its mirror image is.
+ *
+ * The topology is a template argument, so its tests are constants and compile away.
+ *
+ * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
+ * while Grid is more generic to any 2D grid based cellular automaton.
+ *
+ * @param x
+ *      The x coordinate of the centre of the neighbourhood.
+ *
+ * @param y
+ *      The y coordinate of the centre of the neighbourhood.
+ *
+ * @return
+ *      Returns the number of alive neighbours.
+ */
+
+template <Topology::Type TOPOLOGY>
+unsigned int World::count_neighbours(const int x, const int y) const {
+    typedef Topology::Edges<TOPOLOGY> Edges;
+    unsigned int num_neighbours = 0;
+    //loops through -1 to +1 around cell x,y parameter
+    for (int column=(y-1); column<=(y+1); column++) {
+        //maps the row onto the grid, skipping it if it is beyond a dead edge
+        const int new_y = Edges::get_y(column, get_height());
+        if (new_y<0) {
+            continue;
+        }
+        for (int row=(x-1); row<=(x+1); row++) {
+            const int new_x = Edges::get_x(row, get_width());
+            //skip the centre, dead cells beyond the edges, and the centre wrapped around onto itself
+            if (new_x<0 || (row==x && column==y) || (!Edges::REFLECT && new_x==x && new_y==y)) {
+                continue;
+            }
+            //if cell at new x,y is alive then increment number of neighbours
+            if (current_state.get_unchecked(new_x,new_y)==Cell::ALIVE) {
+                num_neighbours++;
+            }
+        }
+    }
+    return num_neighbours;
+}
+
+/**
+ * World::step_reference<TOPOLOGY>()
+ *
+ * Private helper function to take one step one cell at a time by invoking World::count_neighbours<TOPOLOGY>(x, y)
+ * and applying the rule of the world with Rule::get_next.
+ *
+ * Used by World::step when the kernel is Kernel::Type::REFERENCE, and for worlds that wrap around an axis
+ * only 1 cell across, where a cell wraps around to become its own neighbour and must be skipped,
+ * which the word level kernels do not do.
+ */
+
+template <Topology::Type TOPOLOGY>
+void World::step_reference() {
+    //loops through x,y of current grid
+    for (unsigned int y = 0; y < get_height(); y++) {
+        for (unsigned int x = 0; x < get_width(); x++) {
+            //calculates number of neighbours a cell has
+            unsigned int num_neighbours = count_neighbours<TOPOLOGY>(x,y);
+            //sets x,y of next state to what the rule gives for the cell and its neighbours
+            next_state.set_unchecked(x,y,rule.get_next(current_state.get_unchecked(x,y),num_neighbours));
+        }
+    }
+    //swaps current and next state in O(1) time, without invoking a copy
+    std::swap(current_state,next_state);
+}
+
+/**
+ * World::step_event(topology)
+ *
+ * Private helper function to take one step with the event driven engine, which keeps an EventGrid between
+ * steps. The EventGrid is made from the current state on the first step, and after each step the bits of
+ * the cells it flipped are flipped in the current state, updating the hash a word at a time, so the
+ * grid, the hash, the number of alive cells and the bounding box are kept without scanning the world.
+ * Only the words of the current state are kept, the next state and the tile flags are left until the
+ * state leaves the engine, see World::release_engine_state.
+ *
+ * @param topology
+ *      The edges of the world, dead or a torus.
+ */
+
+void World::step_event(const Topology::Type topology) {
+    if (unbounded && topology==Topology::Type::DEAD) {
+        fit_unbounded(generation%UNBOUNDED_MARGIN==0);
+    }
+    if (state_engine!=Engine::EVENT) {
+        event_state = EventGrid(current_state);
+        event_state.set_rule(rule);
+        state_engine = Engine::EVENT;
+    }
+    //the EventGrid counts again for a new topology itself, only the history needs forgetting
+    if (topology!=last_topology) {
+        last_topology = topology;
+        reset_history();
+    }
+    event_state.step(topology==Topology::Type::TORUS);
+    const unsigned int width = get_width();
+    const unsigned int words_per_row = current_state.get_words_per_row();
+    for (const std::size_t index : event_state.get_changed()) {
+        const unsigned int x = index%width, y = index/width;
+        const std::uint64_t word_index = (std::uint64_t) y*words_per_row+x/64;
+        std::uint64_t &word = current_state.get_row_unchecked(y)[x/64];
+        state_hash -= hash_word(word_index, word);
+        word ^= std::uint64_t(1) << (x%64);
+        state_hash += hash_word(word_index, word);
+    }
+    current_state.set_alive_cells(event_state.get_alive_cells());
+    unsigned int x0, y0, x1, y1;
+    bounds = event_state.get_bounds(x0, y0, x1, y1) ? Bounds{x0, y0, x1-x0, y1-y0} : Bounds{0, 0, 0, 0};
+    record_generation();
+}
+
+/**
+ * World::step_topology<TOPOLOGY>()
+ *
+ * Private helper function to take one step with the topology fixed at compile time, see World::step(topology).
+ *
+ * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
+ * Each pair of rows is computed 64 or more cells at a time by Kernel::step_row_pair with the kernel from
+ * World::get_kernel(), which gives the same result as applying World::count_neighbours<TOPOLOGY>(x, y)
+ * to every cell.
+ * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
+ * If the engine is World::Engine::SPARSE and the edges are dead or a torus, the step is taken by
+ * World::advance_topology. If the engine is World::Engine::EVENT and the edges are dead or a torus, the step
+ * is taken by World::step_event. A single generation of World::Engine::HASHLIFE is stepped by the grids.
+ */
+
+template <Topology::Type TOPOLOGY>
+void World::step_topology() {
+    if (engine==Engine::EVENT && is_engine_topology(TOPOLOGY)) {
+        step_event(TOPOLOGY);
+        return;
+    }
+    if (is_engine_topology(TOPOLOGY)) {
+        advance_topology<TOPOLOGY>(1);
+        return;
+    }
+    prepare_step(TOPOLOGY, 1);
+    //a torus 1 cell across wraps cells onto themselves, leave that to the per cell reference
+    if (kernel==Kernel::Type::REFERENCE || is_degenerate(TOPOLOGY)) {
+        step_reference<TOPOLOGY>();
+        mark_all_changed();
+        state_hash = hash_state();
+        record_generation();
+        return;
+    }
+    //rows beyond the top and bottom edges are read from the halo, dead unless the world wraps or reflects
+    current_state.set_halo(true);
+    next_state.set_halo(true);
+    current_state.fill_halo(TOPOLOGY);
+    //only the bounding box and a margin of one cell can hold alive cells after the step
+    set_region(TOPOLOGY, 1);
+    clear_outside_region();
+    std::int64_t alive_change = 0;
+    const unsigned int num_threads = get_threads();
+    const unsigned int tiles_y = get_tiles_y();
+    const unsigned int words_per_row = current_state.get_words_per_row();
+    const unsigned int num_bands = (num_threads>1 && tiles_y>=num_threads) ? num_threads : 1;
+    //these were sized with the world, see World::size_bands, so are cleared without allocating
+    live_rows.assign(tiles_y, 0);
+    live_columns.assign((std::size_t) num_bands*words_per_row, 0);
+    if (num_bands>1) {
+        //each thread steps its own band of tile rows, run waits for every band before the swap
+        //the task captures little enough for std::function to hold it without allocating
+        pool->run([this, tiles_y, num_threads](const unsigned int index) {
+            band_hash_changes[index] = step_band(tiles_y*index/num_threads, tiles_y*(index+1)/num_threads,
+                                                 TOPOLOGY, index, band_alive_changes[index]);
+        });
+        for (unsigned int i = 0; i < num_threads; i++) {
+            state_hash += band_hash_changes[i];
+            alive_change += band_alive_changes[i];
+        }
+    } else {
+        state_hash += step_band(0, tiles_y, TOPOLOGY, 0, alive_change);
+    }
+    //the next state was written a word at a time, so its alive cells are counted from the changed words
+    next_state.set_alive_cells(current_state.get_alive_cells()+alive_change);
+    update_bounds(TOPOLOGY, num_bands);
+    //swaps current and next state in O(1) time, without invoking a copy
+    std::swap(current_state,next_state);
+    std::swap(changed_tiles,next_changed_tiles);
+    record_generation();
+}
+
+/**
+ * World::step(topology)
+ *
+ * Take one step in Conway's Game of Life, or the Life-like rule set by World::set_rule, with the edges
+ * given by a topology.
+ *
+ * The topology is looked at once here, and the step is taken by World::step_topology<TOPOLOGY>(),
+ * so the loops over the cells never test it.
+ *
+ * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
+ *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
+ *      - Any live cell with two or three live neighbours lives on to the next generation.
+ *      - Any live cell with more than three live neighbours dies, as if by overpopulation.
+ *      - Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+ * Other rules change the numbers of live neighbours at which cells are born and live on, see rule.cpp.
+ *
+ * @example
+ *
+ *      // Step a world whose left and right edges are joined
+ *      world.step(Topology::Type::CYLINDER);
+ *
+ * @param topology
+ *      The edges of the world, see topology.cpp.
+ */
+
+void World::step(const Topology::Type topology) {
+    switch (topology) {
+        case Topology::Type::TORUS:
+            step_topology<Topology::Type::TORUS>();
+            break;
+        case Topology::Type::CYLINDER:
+            step_topology<Topology::Type::CYLINDER>();
+            break;
+        case Topology::Type::REFLECT:
+            step_topology<Topology::Type::REFLECT>();
+            break;
+        default:
+            step_topology<Topology::Type::DEAD>();
+            break;
+    }
+}
+
+/**
+ * World::step(toroidal)
+ *
+ * Take one step in Conway's Game of Life, or the Life-like rule set by World::set_rule, with dead edges
+ * or as a torus. See World::step(topology).
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+
+void World::step(const bool toroidal) {
+    step(toroidal ? Topology::Type::TORUS : Topology::Type::DEAD);
+}
+
+/**
+ * World::prepare_step(topology, steps)
+ *
+ * Private helper function to get the world ready to be stepped some generations with a topology.
+ * An unbounded world makes room before the steps could carry a cell past an edge, and trims its margins
+ * if the steps pass a multiple of World::UNBOUNDED_MARGIN generations. Tiles that were still and states
+ * that repeated under one topology may not under another, so both are forgotten when it changes.
+ * Any state held by an engine is handed back to the grids first, as they are about to be stepped.
+ *
+ * @param topology
+ *      The edges the world is about to be stepped with.
+ *
+ * @param steps
+ *      The number of generations about to be stepped.
+ */
+
+void World::prepare_step(const Topology::Type topology, const unsigned int steps) {
+    release_engine_state();
+    if (unbounded && topology==Topology::Type::DEAD) {
+        fit_unbounded(generation%UNBOUNDED_MARGIN<steps);
+    }
+    if (topology!=last_topology) {
+        mark_all_changed();
+        last_topology = topology;
+        reset_history();
+    }
+}
+
+/**
+ * World::get_block_steps(steps, topology)
+ *
+ * Private helper function to decide how many generations the next block of World::step_blocked can take.
+ * Blocking only pays off when the rows being stepped are too large to stay in cache, and an unbounded world
+ * can only step as far as the dead margin around its alive cells before it has to grow.
+ *
+ * @param steps
+ *      The most generations the block may take.
+ *
+ * @param topology
+ *      The edges the world is being stepped with.
+ *
+ * @return
+ *      The number of generations to step in one block, or less than 2 to step one generation at a time.
+ */
+
+unsigned int World::get_block_steps(const unsigned int steps, const Topology::Type topology) const {
+    if (kernel==Kernel::Type::REFERENCE || is_degenerate(topology)) {
+        return 1;
+    }
+    unsigned int depth = std::min(block_depth, steps);
+    unsigned int x0, y0, x1, y1;
+    if (depth<2 || !get_bounds(x0, y0, x1, y1)) {
+        return 1;
+    }
+    if (unbounded && topology==Topology::Type::DEAD) {
+        if (x1>get_width() || y1>get_height()) {
+            return 1;
+        }
+        depth = std::min(depth, std::min(std::min(x0, y0), std::min(get_width()-x1, get_height()-y1)));
+    }
+    const std::uint64_t rows = std::min<std::uint64_t>((std::uint64_t) bounds.height+2*depth, get_height());
+    const std::uint64_t columns = std::min<std::uint64_t>((std::uint64_t) bounds.width+2*depth, get_width());
+    if (rows*((columns+63)/64)*sizeof(std::uint64_t)<BLOCK_BYTES) {
+        return 1;
+    }
+    return depth;
+}
+
+/**
+ * World::step_blocked(steps, topology)
+ *
+ * Private helper function to advance up to steps generations in one pass over memory, by temporal blocking.
+ * The rows of the region around the alive cells are split into strips that fit in cache. Each strip is
+ * copied out with depth extra rows above and below, stepped depth generations there, each generation one
+ * row shorter at both ends, and only the rows of the strip are written back to the next state.
+ * Falls back to World::step when blocking does not pay off, see World::get_block_steps.
+ *
+ * @param steps
+ *      The most generations to advance.
+ *
+ * @param topology
+ *      The edges the world is stepped with.
+ *
+ * @return
+ *      The number of generations advanced.
+ */
+
+unsigned int World::step_blocked(const unsigned int steps, const Topology::Type topology) {
+    prepare_step(topology, std::min(block_depth, steps));
+    const unsigned int depth = get_block_steps(steps, topology);
+    if (depth<2) {
+        step(topology);
+        return 1;
+    }
+    const unsigned int height = get_height();
+    const unsigned int words_per_row = current_state.get_words_per_row();
+    set_region(topology, depth);
+    clear_outside_region();
+    //a region that does not reach across the left and right edges is stepped as its own narrower rows,
+    //the cells beyond it stay dead for the whole block so nothing wraps into it, or is mirrored into it
+    //if it does not touch a reflecting edge
+    unsigned int first_word = 0, last_word = words_per_row, width = get_width();
+    Topology::Type row_topology = topology;
+    if (region.width<get_width() && region.x+region.width<=get_width()
+        && (topology!=Topology::Type::REFLECT || (region.x>0 && region.x+region.width<get_width()))) {
+        first_word = region.x/64;
+        last_word = (region.x+region.width-1)/64+1;
+        width = std::min(get_width(), last_word*64)-first_word*64;
+        row_topology = Topology::Type::DEAD;
+    }
+    //rows beyond the top and bottom edges wrap around or are mirrored back onto the grid, or stay dead
+    const bool wrap_rows = Topology::wraps_y(topology);
+    const bool reflect_rows = topology==Topology::Type::REFLECT;
+    const std::int64_t mirror_period = 2*(std::int64_t) height;
+    const unsigned int num_words = last_word-first_word;
+    //strips are as tall as fit in cache with both buffers, and at least as tall as their extra rows
+    const std::size_t fit_rows = BLOCK_BYTES/(2*sizeof(std::uint64_t)*num_words);
+    const unsigned int strip_rows = std::min<std::size_t>(std::max<std::size_t>(fit_rows, 4*depth)-2*depth,
+                                                          region.height);
+    const unsigned int num_strips = (region.height+strip_rows-1)/strip_rows;
+    const unsigned int num_bands = get_threads();
+    //the scratch of the bands was sized with the world, see World::size_bands, so is only cleared here
+    std::fill(band_hash_changes.begin(), band_hash_changes.end(), 0);
+    std::fill(band_alive_changes.begin(), band_alive_changes.end(), 0);
+    std::fill(block_rows.begin(), block_rows.end(), 0);
+    live_columns.assign((std::size_t) num_bands*words_per_row, 0);
+    const std::size_t strip_words = block_buffers.size()/(2*num_bands);
+    const std::size_t max_inside = block_inside.size()/num_bands;
+    const auto step_strips = [&](const unsigned int band) {
+        //each strip is held in two buffers with a dead row above and below
+        std::uint64_t *buffer_a = &block_buffers[2*band*strip_words];
+        std::uint64_t *buffer_b = buffer_a+strip_words;
+        unsigned char *inside = &block_inside[band*max_inside];
+        std::uint64_t *columns = &live_columns[(std::size_t) band*words_per_row];
+        for (unsigned int strip = band; strip < num_strips; strip += num_bands) {
+            const unsigned int p0 = strip*strip_rows;
+            const unsigned int rows = std::min(p0+strip_rows, region.height)-p0+2*depth;
+            std::uint64_t *current = buffer_a;
+            std::uint64_t *next = buffer_b;
+            std::fill(current+(std::size_t) (rows+1)*num_words, current+(std::size_t) (rows+2)*num_words, 0);
+            std::fill(next+(std::size_t) (rows+1)*num_words, next+(std::size_t) (rows+2)*num_words, 0);
+            const auto get_row = [&](const unsigned int j) {
+                const std::int64_t y = (std::int64_t) region.y+p0+j-depth;
+                if (wrap_rows) {
+                    return ((y%height)+height)%height;
+                }
+                if (reflect_rows) {
+                    //the mirror images of the grid repeat every two heights, every other one flipped
+                    const std::int64_t m = ((y%mirror_period)+mirror_period)%mirror_period;
+                    return (m<height) ? m : mirror_period-1-m;
+                }
+                return y;
+            };
+            for (unsigned int j = 0; j < rows; j++) {
+                const std::int64_t y = get_row(j);
+                inside[j] = y>=0 && y<(std::int64_t) height;
+                std::uint64_t *a = current+(std::size_t) (j+1)*num_words;
+                if (inside[j]) {
+                    const std::uint64_t *row = current_state.get_row_unchecked(y);
+                    std::copy(row+first_word, row+last_word, a);
+                } else {
+                    //rows beyond the top and bottom edges stay dead in both buffers
+                    std::fill(a, a+num_words, 0);
+                    std::fill(next+(std::size_t) (j+1)*num_words, next+(std::size_t) (j+2)*num_words, 0);
+                }
+            }
+            for (unsigned int g = 1; g <= depth; g++) {
+                unsigned int j = g;
+                while (j+g<rows) {
+                    const std::uint64_t *row = current+(std::size_t) (j+1)*num_words;
+                    std::uint64_t *out = next+(std::size_t) (j+1)*num_words;
+                    //neighbouring rows on the grid are stepped in pairs, which the lookup kernel does together
+                    if (inside[j] && j+1+g<rows && inside[j+1]) {
+                        Kernel::step_row_pair(kernel, rule, row-num_words, row, row+num_words, row+2*num_words, out,
+                                out+num_words, 0, num_words, num_words, width, row_topology, lookup_table);
+                        j += 2;
+                        continue;
+                    }
+                    if (inside[j]) {
+                        Kernel::step_row(kernel, rule, row-num_words, row, row+num_words, out, 0, num_words,
+                                num_words, width, row_topology, lookup_table);
+                    }
+                    j++;
+                }
+                std::swap(current, next);
+            }
+            //write back the rows of the strip, which are right after depth generations
+            for (unsigned int j = depth; j+depth < rows; j++) {
+                const std::uint64_t y = get_row(j);
+                const std::uint64_t *row = current+(std::size_t) (j+1)*num_words;
+                const std::uint64_t *old = current_state.get_row_unchecked(y);
+                std::uint64_t *out = next_state.get_row_unchecked(y);
+                std::uint64_t any = 0;
+                for (unsigned int i = 0; i < num_words; i++) {
+                    const unsigned int word = first_word+i;
+                    if (row[i]!=old[word]) {
+                        const std::uint64_t index = y*words_per_row+word;
+                        band_hash_changes[band] += hash_word(index, row[i])-hash_word(index, old[word]);
+                        band_alive_changes[band] += (std::int64_t) __builtin_popcountll(row[i])
+                                                    -__builtin_popcountll(old[word]);
+                    }
+                    out[word] = row[i];
+                    columns[word] |= row[i];
+                    any |= row[i];
+                }
+                block_rows[y] = any!=0;
+            }
+        }
+    };
+    if (num_bands>1) {
+        //the task only holds a reference to the strips, little enough for std::function to keep without allocating
+        pool->run([&step_strips](const unsigned int band) {
+            step_strips(band);
+        });
+    } else {
+        step_strips(0);
+    }
+    std::int64_t alive_change = 0;
+    for (unsigned int band = 0; band < num_bands; band++) {
+        state_hash += band_hash_changes[band];
+        alive_change += band_alive_changes[band];
+    }
+    next_state.set_alive_cells(current_state.get_alive_cells()+alive_change);
+    //the flags of the rows are gathered into bits for World::update_bounds
+    live_rows.assign(get_tiles_y(), 0);
+    for (unsigned int p = 0; p < region.height; p++) {
+        const unsigned int y = (region.y+p)%height;
+        live_rows[y/64] |= (std::uint64_t) block_rows[y] << (y%64);
+    }
+    update_bounds(topology, num_bands);
+    std::swap(current_state,next_state);
+    //the next state is depth generations old, so no tile can be skipped on the next step
+    changed_tiles.assign((std::size_t) get_tiles_x()*get_tiles_y(), 1);
+    next_changed_tiles.assign((std::size_t) get_tiles_x()*get_tiles_y(), 1);
+    generation += depth;
+    clear_history();
+    return depth;
+}
+
+/**
+ * World::step_band(ty0, ty1, topology, band, alive_change)
+ *
+ * Private helper function to write the next generation of the tile rows [ty0, ty1) into the next state grid,
+ * and flag which of their tiles changed.
+ * Only reads the current state, so bands can be stepped at the same time on different threads.
+ *
+ * Runs of neighbouring active tiles in a tile row are stepped together, so the kernel can use its
+ * widest vectors across them. Inactive tiles are left as they are, and only the rows and words of
+ * the region found by World::set_region are visited.
+ * The changes to the hash of the state and to the number of alive cells are summed up over the words that changed.
+ * The rows of the region holding alive cells after the step are flagged in World::live_rows, one word
+ * per tile row, so bands split on tile rows never write the same word.
+ *
+ * @param ty0
+ *      The first tile row of the band.
+ *
+ * @param ty1
+ *      The tile row after the last tile row of the band.
+ *
+ * @param topology
+ *      The edges of the world, for the cells carried in at the ends of each row. The halo rows must
+ *      already be filled for it, see Grid::fill_halo.
+ *
+ * @param band
+ *      The index of the band, for its scratch space and its columns in World::live_columns, which are
+ *      set to the union of the rows of the band after the step, one word per word of a row.
+ *
+ * @param alive_change
+ *      Set to the number of cells that became alive in the band less the number that died.
+ *
+ * @return
+ *      The amount to add to the hash of the state for the changes made to the band.
+ */
+
+std::uint64_t World::step_band(const unsigned int ty0, const unsigned int ty1, const Topology::Type topology,
+                               const unsigned int band, std::int64_t &alive_change) {
+    static_assert(TILE_ROWS==64, "World::live_rows holds the rows of a tile row in one word.");
+    std::uint64_t hash_change = 0;
+    alive_change = 0;
+    const int height = get_height();
+    const unsigned int words_per_row = current_state.get_words_per_row();
+    const unsigned int tiles_x = get_tiles_x();
+    unsigned char *column = &band_tiles[(std::size_t) 2*band*tiles_x];
+    unsigned char *active = column+tiles_x;
+    std::uint64_t *columns = &live_columns[(std::size_t) band*words_per_row];
+    unsigned int region_pieces[2][2], word_pieces[2][2];
+    const unsigned int num_region_pieces = get_pieces(region.y, region.height, height, region_pieces);
+    const unsigned int num_word_pieces = get_word_pieces(region.x, region.width, get_width(), word_pieces);
+    for (unsigned int ty = ty0; ty < ty1; ty++) {
+        const int y0 = ty*TILE_ROWS;
+        const int y1 = (y0+(int) TILE_ROWS<height) ? y0+TILE_ROWS : height;
+        unsigned char *changed = &next_changed_tiles[(std::size_t) ty*tiles_x];
+        //the rows of the tile row within the region, tile rows outside it cannot change
+        unsigned int row_pieces[2][2];
+        unsigned int num_row_pieces = 0;
+        for (unsigned int p = 0; p < num_region_pieces; p++) {
+            const int r0 = std::max(y0, (int) region_pieces[p][0]);
+            const int r1 = std::min(y1, (int) region_pieces[p][1]);
+            if (r0<r1) {
+                row_pieces[num_row_pieces][0] = r0;
+                row_pieces[num_row_pieces][1] = r1;
+                num_row_pieces++;
+            }
+        }
+        if (num_row_pieces==0) {
+            std::fill(changed, changed+tiles_x, 0);
+            continue;
+        }
+        get_active_tiles(ty, topology, column, active);
+        unsigned int tx = 0;
+        while (tx<tiles_x) {
+            //skip inactive tiles and tiles outside the region, they cannot have changed
+            if (!active[tx] || !region_words[tx]) {
+                changed[tx] = 0;
+                tx++;
+                continue;
+            }
+            //find the run of active tiles starting here
+            const unsigned int first_word = tx;
+            while (tx<tiles_x && active[tx] && region_words[tx]) {
+                changed[tx] = 0;
+                tx++;
+            }
+            //step the rows of the run and flag the tiles with any word that differs
+            for (unsigned int p = 0; p < num_row_pieces; p++) {
+                //rows are stepped in pairs, which the lookup kernel does together, and a last odd row alone
+                for (int y = row_pieces[p][0]; y < (int) row_pieces[p][1]; y += 2) {
+                    //the halo rows stand in above the top row and below the bottom row
+                    const std::uint64_t *above = current_state.get_row_unchecked(y-1);
+                    const std::uint64_t *row = current_state.get_row_unchecked(y);
+                    const std::uint64_t *below = current_state.get_row_unchecked(y+1);
+                    const int pair_rows = std::min(2, (int) row_pieces[p][1]-y);
+                    if (pair_rows==2) {
+                        Kernel::step_row_pair(kernel, rule, above, row, below, current_state.get_row_unchecked(y+2),
+                                next_state.get_row_unchecked(y), next_state.get_row_unchecked(y+1), first_word, tx,
+                                current_state.get_words_per_row(), get_width(), topology, lookup_table);
+                    } else {
+                        Kernel::step_row(kernel, rule, above, row, below, next_state.get_row_unchecked(y),
+                                first_word, tx, current_state.get_words_per_row(), get_width(), topology,
+                                lookup_table);
+                    }
+                    for (int r = y; r < y+pair_rows; r++) {
+                        const std::uint64_t *old = current_state.get_row_unchecked(r);
+                        const std::uint64_t *out = next_state.get_row_unchecked(r);
+                        for (unsigned int i = first_word; i < tx; i++) {
+                            if (out[i]!=old[i]) {
+                                changed[i] = 1;
+                                const std::uint64_t index = (std::uint64_t) r*words_per_row+i;
+                                hash_change += hash_word(index, out[i])-hash_word(index, old[i]);
+                                alive_change += (std::int64_t) __builtin_popcountll(out[i])
+                                                -__builtin_popcountll(old[i]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        //note the rows and columns of the region holding alive cells, stepped or left as they were
+        for (unsigned int p = 0; p < num_row_pieces; p++) {
+            for (unsigned int y = row_pieces[p][0]; y < row_pieces[p][1]; y++) {
+                const std::uint64_t *out = next_state.get_row_unchecked(y);
+                std::uint64_t any = 0;
+                for (unsigned int wp = 0; wp < num_word_pieces; wp++) {
+                    for (unsigned int i = word_pieces[wp][0]; i < word_pieces[wp][1]; i++) {
+                        columns[i] |= out[i];
+                        any |= out[i];
+                    }
+                }
+                if (any) {
+                    live_rows[ty] |= std::uint64_t(1) << (y%64);
+                }
+            }
+        }
+    }
+    return hash_change;
+}
+
+/**
+ * World::advance_topology<TOPOLOGY>(steps)
+ *
+ * Private helper function to advance multiple steps with the topology fixed at compile time,
+ * see World::advance(steps, topology).
+ * Should be implemented by invoking World::step_topology<TOPOLOGY>(), unless the engine is World::Engine::HASHLIFE,
+ * the world is unbounded and the edges are dead, when all the steps are taken at once by the HashLife universe
+ * kept in the world, or the engine
+ * is World::Engine::SPARSE and the edges are dead or a torus, when the steps are taken by the SparseGrid
+ * holding the state. The event driven engine steps one generation at a time through World::step_topology,
+ * so its cycles are found and skipped as with the grids.
+ *
+ * Once the world is found to be a still life or in a cycle of period p, the remaining steps are
+ * reduced modulo p, so only the last partial period is actually stepped.
+ *
+ * Worlds too large to stay in cache are advanced World::get_block_depth() generations per pass over
+ * memory by World::step_blocked, which gives the same result as stepping each generation.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ */
+
+template <Topology::Type TOPOLOGY>
+void World::advance_topology(const int steps) {
+    //jumps straight to the final generation with hashlife, whose plane is only an unbounded world with dead edges
+    if (engine==Engine::HASHLIFE && unbounded && TOPOLOGY==Topology::Type::DEAD && steps>1) {
+        //the universe is loaded again if the grids moved on without it, or a copy of the world shares it
+        if (state_engine!=Engine::HASHLIFE || universe.use_count()>1) {
+            release_engine_state();
+            universe = std::make_shared<HashLife>(current_state);
+            universe->set_rule(rule);
+            universe_x = origin_x;
+            universe_y = origin_y;
+            state_engine = Engine::HASHLIFE;
+        }
+        universe->advance(steps);
+        generation += steps;
+        last_topology = TOPOLOGY;
+        //the grids take the box around every alive cell of the universe with margins, or stay put if none are left
+        std::int64_t x0 = origin_x-universe_x, y0 = origin_y-universe_y;
+        std::int64_t x1 = x0+get_width(), y1 = y0+get_height();
+        std::int64_t margin_x = 0, margin_y = 0;
+        if (universe->get_bounds(x0, y0, x1, y1)) {
+            margin_x = get_margin(x1-x0);
+            margin_y = get_margin(y1-y0);
+        }
+        move_origin(universe->get_grid(x0-margin_x, y0-margin_y, x1-x0+2*margin_x, y1-y0+2*margin_y),
+                    universe_x+x0-margin_x-origin_x, universe_y+y0-margin_y-origin_y);
+        //the memo only grows, so a universe holding too many nodes is let go and the next jump starts afresh
+        if (universe->get_num_nodes()>HASHLIFE_NODES) {
+            release_engine_state();
+        }
+        return;
+    }
+    //steps the sparse state, visiting only the chunks near alive cells, which only has dead edges or a torus
+    const bool toroidal = TOPOLOGY==Topology::Type::TORUS;
+    const bool sparse = engine==Engine::SPARSE && is_engine_topology(TOPOLOGY);
+    if (sparse && state_engine!=Engine::SPARSE) {
+        //the sparse engine takes over the cells, and the grids are let go unless they are kept in a file
+        sparse_state = SparseGrid(current_state);
+        sparse_state.set_rule(rule);
+        state_engine = Engine::SPARSE;
+        if (!is_mapped()) {
+            current_state = Grid();
+            next_state = Grid();
+            std::vector<unsigned char>().swap(changed_tiles);
+            std::vector<unsigned char>().swap(next_changed_tiles);
+        }
+    }
+    if (sparse) {
+        int i = 0;
+        while (i<steps) {
+            int run = steps-i;
+            //cells travel at most one cell a generation, so an unbounded world steps no further than its margin
+            unsigned int x0, y0, x1, y1;
+            if (unbounded && !toroidal) {
+                fit_unbounded(true);
+                if (get_bounds(x0, y0, x1, y1)) {
+                    const unsigned int margin = std::min(std::min(x0, y0), std::min(get_width()-x1, get_height()-y1));
+                    run = std::min(run, (int) margin);
+                }
+            }
+            //a mapped world keeps its file up to date, clearing the words of the old chunks and writing the new
+            if (is_mapped()) {
+                sparse_state.for_each_word([this](const unsigned int y, const unsigned int word_index,
+                                                  const std::uint64_t) {
+                    current_state.get_row_unchecked(y)[word_index] = 0;
+                });
+            }
+            for (int j=0; j<run; j++) {
+                sparse_state.step(toroidal);
+            }
+            if (is_mapped()) {
+                sparse_state.for_each_word([this](const unsigned int y, const unsigned int word_index,
+                                                  const std::uint64_t word) {
+                    current_state.get_row_unchecked(y)[word_index] = word;
+                });
+                current_state.set_alive_cells(sparse_state.get_alive_cells());
+            }
+            generation += run;
+            i += run;
+            last_topology = TOPOLOGY;
+            mark_all_changed();
+            reset_history();
+        }
+        return;
+    }
+    //the hashes of the states blocks started from, to notice when the world repeats, kept in the world
+    //with room for World::HISTORY_SIZE of them so blocks do not allocate
+    block_starts.clear();
+    //the event driven engine only steps one generation at a time
+    bool blocking = !is_engine_topology(TOPOLOGY);
+    int i = 0;
+    while (i<steps) {
+        //once the world is known to repeat, whole periods can be skipped without changing the state
+        if (period!=0 && TOPOLOGY==last_topology) {
+            const std::uint64_t remaining = steps-i;
+            generation += remaining-remaining%period;
+            //the remembered generation numbers no longer apply, but the cycle still does
+            history_size = 0;
+            std::fill(history_buckets.begin(), history_buckets.end(), HISTORY_SIZE);
+            remember_generation();
+            write_header();
+            for (std::uint64_t j=0; j<remaining%period; j++) {
+                step_topology<TOPOLOGY>();
+            }
+            return;
+        }
+        if (!blocking) {
+            step_topology<TOPOLOGY>();
+            i++;
+            continue;
+        }
+        if (block_starts.size()==HISTORY_SIZE) {
+            block_starts.clear();
+        }
+        block_starts.push_back(state_hash);
+        const unsigned int taken = step_blocked(steps-i, TOPOLOGY);
+        i += taken;
+        //a block ending where one started is repeating, step singly so the history finds the cycle
+        if (taken>1 && std::find(block_starts.begin(), block_starts.end(), state_hash)!=block_starts.end()) {
+            blocking = false;
+        }
+    }
+}
+
+/**
+ * World::advance(steps, topology)
+ *
+ * Advance multiple steps in the Game of Life, with the edges given by a topology.
+ *
+ * The topology is looked at once here, and the steps are taken by World::advance_topology<TOPOLOGY>(steps),
+ * so the loops over the cells never test it.
+ *
+ * Once the world is found to be a still life or in a cycle of period p, the remaining steps are
+ * reduced modulo p, so only the last partial period is actually stepped.
+ *
+ * Worlds too large to stay in cache are advanced World::get_block_depth() generations per pass over
+ * memory by World::step_blocked, which gives the same result as stepping each generation.
+ *
+ * @example
+ *
+ *      // Advance a world with reflecting edges 100 generations
+ *      world.advance(100, Topology::Type::REFLECT);
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param topology
+ *      The edges of the world, see topology.cpp.
+ */
+
+void World::advance(const int steps, const Topology::Type topology) {
+    switch (topology) {
+        case Topology::Type::TORUS:
+            advance_topology<Topology::Type::TORUS>(steps);
+            break;
+        case Topology::Type::CYLINDER:
+            advance_topology<Topology::Type::CYLINDER>(steps);
+            break;
+        case Topology::Type::REFLECT:
+            advance_topology<Topology::Type::REFLECT>(steps);
+            break;
+        default:
+            advance_topology<Topology::Type::DEAD>(steps);
+            break;
+    }
+}
+
+/**
+ * World::advance(steps, toroidal)
+ *
+ * Advance multiple steps in the Game of Life, with dead edges or as a torus. See World::advance(steps, topology).
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+
+void World::advance(const int steps, const bool toroidal) {
+    advance(steps, toroidal ? Topology::Type::TORUS : Topology::Type::DEAD);
+}
@@ -12,32 +12,196 @@
 
 // Add the minimal number of includes you need in order to declare the class.
 // #include ...
+#include "event_grid.h"
 #include "grid.h"
+#include "kernel.h"
+#include "rule.h"
+#include "sparse_grid.h"
+#include "topology.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class GridView;
+class HashLife;
+class MappedFile;
+class ThreadPool;
 /**
  * Declare the structure of the World class for representing a 2d grid world.
  *
  * A World holds two equally sized Grid objects for the current state and next state.
  *      - These buffers should be swapped using std::swap after each update step.
+ *      - Steps can be split across a persistent pool of threads, each stepping a band of rows.
+ *      - The grid is divided into tiles with a flag for whether each changed in the last step,
+ *        so tiles that cannot change are skipped.
+ *      - The bounding box of the alive cells is kept up to date, and steps only visit the box and a one cell margin.
+ *      - Large worlds are advanced several generations at a time per block of rows, while the block is in cache.
+ *      - Unbounded worlds can alternatively be advanced by a HashLife engine, jumping huge numbers of generations
+ *        at once, and any world by a sparse engine that keeps only the chunks of cells near alive cells, in place
+ *        of the grids.
+ *      - Worlds too large to hold as grids can be constructed straight from a SparseGrid into the sparse engine.
+ *      - Worlds remember a hash of their recent states to detect still lifes and cycles, which World::advance skips.
+ *      - Both grids can be kept in a memory mapped file, stepped in place and reopened later without loading.
+ *      - Unbounded worlds grow as their alive cells near an edge and trim empty margins, tracking the position
+ *        of their grids on an infinite plane.
  */
 class World {
+    public:
+    /**
+     * The engines available for advancing a world.
+     */
+    enum class Engine {
+        STEP,
+        HASHLIFE,
+        SPARSE,
+        EVENT
+    };
     private:
+    /**
+     * A box of cells width by height from x,y, which wraps around the edges of a world that wraps.
+     */
+    struct Bounds {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+        unsigned int height;
+    };
     Grid current_state;
     Grid next_state;
-    unsigned int count_neighbours(const int x, const int y, const bool toroidal);
+    Kernel::Type kernel;
+    Rule rule;
+    const Kernel::LookupTable *lookup_table;
+    std::shared_ptr<ThreadPool> pool;
+    std::vector<unsigned char> changed_tiles;
+    std::vector<unsigned char> next_changed_tiles;
+    Bounds bounds;
+    Bounds next_bounds;
+    Bounds region;
+    std::vector<unsigned char> region_words;
+    std::vector<std::uint64_t> live_rows;
+    std::vector<std::uint64_t> live_columns;
+    std::vector<unsigned char> band_tiles;
+    std::vector<std::uint64_t> band_hash_changes;
+    std::vector<std::int64_t> band_alive_changes;
+    std::vector<std::uint64_t> block_buffers;
+    std::vector<unsigned char> block_inside;
+    std::vector<unsigned char> block_rows;
+    std::vector<std::uint64_t> block_starts;
+    Topology::Type last_topology;
+    Engine engine;
+    Engine state_engine;
+    SparseGrid sparse_state;
+    EventGrid event_state;
+    std::shared_ptr<HashLife> universe;
+    std::int64_t universe_x;
+    std::int64_t universe_y;
+    mutable Grid exported_state;
+    mutable bool state_exported;
+    std::uint64_t generation;
+    std::uint64_t state_hash;
+    std::vector<std::uint64_t> history;
+    std::vector<std::uint64_t> history_generations;
+    std::vector<unsigned int> history_next;
+    std::vector<unsigned int> history_previous;
+    std::vector<unsigned int> history_buckets;
+    unsigned int history_size;
+    Grid cycle_candidate;
+    std::uint64_t candidate_generation;
+    std::uint64_t candidate_period;
+    std::uint64_t candidate_start;
+    std::uint64_t period;
+    std::uint64_t cycle_start;
+    std::shared_ptr<MappedFile> mapping;
+    bool unbounded;
+    unsigned int block_depth;
+    std::int64_t origin_x;
+    std::int64_t origin_y;
+    template <Topology::Type TOPOLOGY>
+    unsigned int count_neighbours(const int x, const int y) const;
+    template <Topology::Type TOPOLOGY>
+    void step_reference();
+    void step_event(const Topology::Type topology);
+    std::uint64_t step_band(const unsigned int ty0, const unsigned int ty1, const Topology::Type topology,
+                            const unsigned int band, std::int64_t &alive_change);
+    unsigned int get_tiles_x() const;
+    unsigned int get_tiles_y() const;
+    void get_active_tiles(const unsigned int ty, const Topology::Type topology, unsigned char *column,
+                          unsigned char *active) const;
+    void mark_all_changed();
+    void size_bands();
+    void set_region(const Topology::Type topology, const unsigned int margin);
+    void clear_outside_region();
+    void update_bounds(const Topology::Type topology, const unsigned int num_bands);
+    bool is_degenerate(const Topology::Type topology) const;
+    bool is_engine_topology(const Topology::Type topology) const;
+    void release_engine_state();
+    std::uint64_t hash_state() const;
+    void reset_history();
+    void clear_history();
+    void remember_generation();
+    unsigned int find_generation(const std::uint64_t hash) const;
+    void record_generation();
+    void replace_state(Grid &&state);
+    void write_header();
+    bool find_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const;
+    void fit_unbounded(const bool trim);
+    void move_origin(Grid &&state, const std::int64_t dx, const std::int64_t dy);
+    void prepare_step(const Topology::Type topology, const unsigned int steps);
+    unsigned int get_block_steps(const unsigned int steps, const Topology::Type topology) const;
+    unsigned int step_blocked(const unsigned int steps, const Topology::Type topology);
+    template <Topology::Type TOPOLOGY>
+    void step_topology();
+    template <Topology::Type TOPOLOGY>
+    void advance_topology(const int steps);
+    public:
+    static constexpr unsigned int TILE_ROWS = 64;
+    static constexpr unsigned int HISTORY_SIZE = 1024;
+    static constexpr unsigned int HISTORY_BUCKETS = 2*HISTORY_SIZE;
+    static constexpr unsigned int UNBOUNDED_MARGIN = 64;
+    static constexpr unsigned int BLOCK_DEPTH = 8;
+    static constexpr std::size_t BLOCK_BYTES = 256*1024;
+    static constexpr std::size_t HASHLIFE_NODES = 1 << 22;
     public:
     World();
     explicit World(const unsigned int square_size);
     World(const unsigned int width, const unsigned int height);
-    explicit World(const Grid initial_state);
+    explicit World(const Grid &initial_state);
+    explicit World(Grid &&initial_state);
+    explicit World(const GridView &initial_state);
+    explicit World(SparseGrid &&initial_state);
     ~World();
     unsigned int get_width() const;
     unsigned int get_height() const;
-    unsigned int get_total_cells() const;
-    unsigned int get_alive_cells() const;
-    unsigned int get_dead_cells() const;
+    std::uint64_t get_total_cells() const;
+    std::uint64_t get_alive_cells() const;
+    std::uint64_t get_dead_cells() const;
     const Grid &get_state() const;
+    const Grid &get_state(std::int64_t &x0, std::int64_t &y0) const;
+    bool get_bounds(unsigned int &x0, unsigned int &y0, unsigned int &x1, unsigned int &y1) const;
+    void create_mapped(const std::string path);
+    void open_mapped(const std::string path);
+    bool is_mapped() const;
+    std::uint64_t get_generation() const;
+    std::uint64_t get_period() const;
+    std::uint64_t get_cycle_start() const;
+    Kernel::Type get_kernel() const;
+    void set_kernel(const Kernel::Type type);
+    const Rule &get_rule() const;
+    void set_rule(const Rule &rule);
+    Engine get_engine() const;
+    void set_engine(const Engine engine);
+    unsigned int get_threads() const;
+    void set_threads(const unsigned int num_threads);
+    bool is_unbounded() const;
+    void set_unbounded(const bool enabled);
+    unsigned int get_block_depth() const;
+    void set_block_depth(const unsigned int depth);
     void resize(const unsigned int square_size);
     void resize(const unsigned int new_width, const unsigned int new_height);
     void step(const bool toroidal = false);
     void advance(const int steps, const bool toroidal = false);
+    void step(const Topology::Type topology);
+    void advance(const int steps, const Topology::Type topology);
 };
\ No newline at end of file
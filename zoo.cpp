@@ -3,6 +3,8 @@
  *      - Creatures like gliders, light weight spaceships, and r-pentominos can be spawned.
  *          - These creatures are drawn on a Grid the size of their bounding box.
  *
+ *      - Grids, and GridView views of them, can be saved without copying them first.
+ *
  *      - Grids can be loaded from and saved to an ascii file format.
  *          - Ascii files are composed of:
  *              - A header line containing an integer width and height separated by a space.
@@ -17,6 +19,8 @@
  *              - followed by (width * height) number of individual bits in C-style row/column format,
  *                padded with zero or more 0 bits.
  *              - a 0 bit should be considered Cell::DEAD, a 1 bit should be considered Cell::ALIVE.
+ *          - Rows are read and written 64 cells at a time from the bit-packed Grid storage.
+ *          - The number of bits is a 64 bit count, as two 4 byte sizes can multiply to more than 2^32 cells.
  *
  * @author 951939
  * @date March, 2020
@@ -26,9 +30,31 @@
 // Include the minimal number of headers needed to support your implementation.
 // #include ...
 #include "grid.h"
+#include "grid_view.h"
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
+
+/**
+ * write_word(out, word, num_bytes)
+ *
+ * Helper to write the low num_bytes bytes of a word to a binary stream, least significant byte first,
+ * so the first cell of the word lands in bit 0 of the first byte.
+ */
+
+static void write_word(std::ofstream &out, const std::uint64_t word, const unsigned int num_bytes) {
+    char bytes[8];
+    for (unsigned int i=0; i<num_bytes; i++) {
+        bytes[i] = (char) (word >> (8*i));
+    }
+    out.write(bytes, num_bytes);
+}
+
 /**
  * Zoo::glider()
  *
@@ -152,7 +178,7 @@ Grid Zoo::light_weight_spaceship() {
  * @throws
  *      Throws std::runtime_error or sub-class if:
  *          - The file cannot be opened.
- *          - The parsed width or height is not a positive integer.
+ *          - The parsed width or height is not a positive integer, or is larger than the largest int.
  *          - Newline characters are not found when expected during parsing.
  *          - The character for a cell is not the ALIVE or DEAD character.
  */
@@ -164,13 +190,17 @@ Grid Zoo::load_ascii(const std::string path) {
         //gets the first line to set width and height of the grid
         std::string line;
         std::getline(in,line);
-        unsigned int width, height;
-        //-48 for ASCII code (char to int conversion)
-        width = line[0]-48;
-        height = line[2]-48;
-        //if width or height are negative then throw exception
-        if (width<0 || height<0) {
-            throw std::domain_error("Zoo::load_ascii negative width/height.");
+        //parses the two numbers on the line, which may have any number of digits
+        std::istringstream header(line);
+        long long width, height;
+        std::string rest;
+        //if width or height are missing, negative, or followed by anything else then throw exception
+        if (!(header >> width >> height) || (header >> rest) || width<0 || height<0) {
+            throw std::domain_error("Zoo::load_ascii invalid width/height.");
+        }
+        //if width or height cannot be a coordinate then throw exception, before allocating anything
+        if (width>INT_MAX || height>INT_MAX) {
+            throw std::length_error("Zoo::load_ascii width/height too large.");
         }
         //creates grid and loops through x,y on said grid
         Grid grid = Grid(width,height);
@@ -187,10 +217,10 @@ Grid Zoo::load_ascii(const std::string path) {
                     cell = line[x];
                     //if char is a hash then set x,y on grid to be alive
                     if (cell == '#') {
-                        grid.set(x,y,Cell::ALIVE);
+                        grid.set_unchecked(x,y,Cell::ALIVE);
                     //else if char is a space then set x,y on grive to be dead
                     } else if (cell == ' ') {
-                        grid.set(x,y,Cell::DEAD);
+                        grid.set_unchecked(x,y,Cell::DEAD);
                     //else throw exception
                     } else {
                         throw std::domain_error("Zoo::load_ascii unrecognized character.");
@@ -236,25 +266,48 @@ Grid Zoo::load_ascii(const std::string path) {
  *      Throws std::runtime_error or sub-class if the file cannot be opened.
  */
 
-void Zoo::save_ascii(const std::string path, const Grid grid) {
+void Zoo::save_ascii(const std::string path, const Grid &grid) {
+    save_ascii(path, GridView(grid));
+}
+
+/**
+ * Zoo::save_ascii(path, view)
+ *
+ * Save a view of a grid as an ascii .gol file, exactly as the grid holding the view would be saved,
+ * without making that grid first.
+ *
+ * @example
+ *
+ *      // Save the top left 8x8 of a grid, rotated
+ *      Zoo::save_ascii("path/to/file.gol", GridView(grid).crop(0, 0, 8, 8).rotate(1));
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param view
+ *      The view to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+
+void Zoo::save_ascii(const std::string path, const GridView &view) {
     //opens file and if file exists then
     std::ofstream out(path);
     if (out.is_open()) {
-        //outputs width and height of grid parameter into first line of the file
-        out << grid.get_width() << ' ' << grid.get_height() << '\n';
-        //loops through x,y of grid parameter
-        for (unsigned int y = 0; y < grid.get_height(); y++) {
-            for (unsigned int x = 0; x < grid.get_width(); x++) {
-                //if x,y on grid is alive then output a hash
-                if (grid.get(x,y)==Cell::ALIVE) {
-                out << '#';
-                //else output a space
-                } else {
-                out << ' ';
+        //outputs width and height of the view into first line of the file
+        out << view.get_width() << ' ' << view.get_height() << '\n';
+        //builds each row as a line of hashes and spaces from its words, then writes it at once
+        std::string line(view.get_width()+1, '\n');
+        for (unsigned int y = 0; y < view.get_height(); y++) {
+            for (unsigned int i = 0; i < view.get_words_per_row(); i++) {
+                const std::uint64_t word = view.get_word(y, i);
+                const unsigned int first_x = i*Grid::BITS_PER_WORD;
+                for (unsigned int x = first_x; x < view.get_width() && x < first_x+Grid::BITS_PER_WORD; x++) {
+                    line[x] = ((word >> (x-first_x)) & 1U) ? '#' : ' ';
                 }
             }
-            //places a new line character whenever the x loop is finished (a row has been made)
-            out << '\n';
+            out << line;
         }
         //closes file to prevent memory leaks
         out.close();
@@ -284,51 +337,55 @@ void Zoo::save_ascii(const std::string path, const Grid grid) {
  * @throws
  *      Throws std::runtime_error or sub-class if:
  *          - The file cannot be opened.
- *          - The file ends unexpectedly.
+ *          - The file ends unexpectedly, checked before the cells are allocated.
+ *      Throws std::length_error or sub-class if the width or height is larger than the largest int.
  */
 
 Grid Zoo::load_binary(const std::string path) {
     //opens file and if exists then
-    std::ifstream in (path);
+    std::ifstream in (path, std::ios::binary);
     if (in.is_open()) {
         //sets width and height of grid (4 byte char* -> 4 byte unsigned ints) and creates grid
         unsigned int width, height;
         in.read((char*) &width, 4);
         in.read((char*) &height, 4);
+        if (!in.good()) {
+            throw std::runtime_error("Zoo::load_binary EOF reached too early.");
+        }
+        //calculates number of bits and bytes to load, in 64 bits as there may be more than 2^32 cells
+        const std::uint64_t num_bits = std::uint64_t(width)*height;
+        const std::uint64_t num_bytes = (num_bits+7)/8;
+        //throws if the file is too short before allocating anything for the size it claims
+        const std::streampos start = in.tellg();
+        in.seekg(0, std::ios::end);
+        const std::uint64_t available = (std::uint64_t) (in.tellg()-start);
+        in.seekg(start);
+        if (available<num_bytes) {
+            throw std::runtime_error("Zoo::load_binary EOF reached too early.");
+        }
         Grid grid = Grid(width,height);
-        //idx increments only during the for loop that loops through 0 to 7 bits of char byte
-        unsigned int idx = 0;
-        char byte;
-        //calculates number of bits to load
-        unsigned int num_bits = grid.get_width()*grid.get_height();
-        //while the number of bits has not been reached
-        while (idx<num_bits) {
-            //reads in 8 bits into the char byte
-            in.read(&byte, 1);
-            //loops through 0 to 7 bits of the char byte
-            for (unsigned int i=0; i<8; i++) {
-                //if no (error) state flags set then
-                if (in.good()) {
-                    //if the number of bits has not been reached yet then
-                    if (idx<num_bits) {
-                        //calculates from idx to x,y
-                        unsigned int x = idx % grid.get_width();
-                        unsigned int y = (idx-x) / grid.get_width();
-                        //performs a right shift and use a bitwise AND to get value of a bit
-                        if ((byte >> i) & 1U) {
-                            grid.set(x,y,Cell::ALIVE);
-                        } else {
-                            grid.set(x,y,Cell::DEAD);
-                        }
-                        //increments number of bits reached
-                        idx++;
-                    }
-                //else throw exception
-                } else {
-                    throw std::runtime_error("Zoo::load_binary EOF reached too early.");
+        //reads the bytes straight into 64 bit words, which are little endian like the header,
+        //plus one spare word so a row can always read the next word
+        std::vector<std::uint64_t> stream((std::size_t) (num_bytes+7)/8+1, 0);
+        in.read((char*) stream.data(), num_bytes);
+        if ((std::uint64_t) in.gcount()!=num_bytes) {
+            throw std::runtime_error("Zoo::load_binary EOF reached too early.");
+        }
+        //rows in the file are not padded to a word boundary, so each row word is gathered from
+        //the two stream words it straddles and the bits past the width are masked off
+        for (unsigned int y=0; y<grid.get_height(); y++) {
+            std::uint64_t *row = grid.get_row(y);
+            for (unsigned int i=0; i<grid.get_words_per_row(); i++) {
+                const std::uint64_t offset = std::uint64_t(y)*grid.get_width()+i*Grid::BITS_PER_WORD;
+                const unsigned int shift = offset%Grid::BITS_PER_WORD;
+                std::uint64_t word = stream[offset/Grid::BITS_PER_WORD] >> shift;
+                if (shift!=0) {
+                    word |= stream[offset/Grid::BITS_PER_WORD+1] << (Grid::BITS_PER_WORD-shift);
                 }
+                row[i] = (i+1==grid.get_words_per_row()) ? (word & grid.get_row_mask()) : word;
             }
         }
+        grid.recount_alive_cells();
         //closes ifstream to prevent memory leaks and returns filled grid
         in.close();
         return grid;
@@ -368,47 +425,68 @@ Grid Zoo::load_binary(const std::string path) {
  *      Throws std::runtime_error or sub-class if the file cannot be opened.
  */
 
-void Zoo::save_binary(const std::string path, const Grid grid) {
+void Zoo::save_binary(const std::string path, const Grid &grid) {
+    save_binary(path, GridView(grid));
+}
+
+/**
+ * Zoo::save_binary(path, view)
+ *
+ * Save a view of a grid as an binary .bgol file, exactly as the grid holding the view would be saved,
+ * without making that grid first.
+ *
+ * @example
+ *
+ *      // Save a grid mirrored left to right
+ *      Zoo::save_binary("path/to/file.bgol", GridView(grid).reflect_horizontal());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param view
+ *      The view to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+
+void Zoo::save_binary(const std::string path, const GridView &view) {
     //opens file and if exists then
-    std::ofstream out(path);
+    std::ofstream out(path, std::ios::binary);
     if (out.is_open()) {
-        unsigned int width = grid.get_width();
-        unsigned int height = grid.get_height();
-        //outputs width and height of grid parameter both as 4 byte ints
+        unsigned int width = view.get_width();
+        unsigned int height = view.get_height();
+        //outputs width and height of the view both as 4 byte ints
         out.write((char*) &width, 4);
         out.write((char*) &height, 4);
-        //initialize number of bits reached and byte storage in char byte
-        unsigned int idx = 0;
-        char byte;
-        //calculates number of bits to load
-        unsigned int num_bits = grid.get_width()*grid.get_height();
-        //while the number of bits has not been reached
-        while (idx<num_bits) {
-            //loops through number of bits in char byte (0 to 7)
-            for (unsigned int i=0; i<8; i++) {
-                //calculates from idx to x,y
-                unsigned int x = idx % grid.get_width();
-                unsigned int y = (idx-x) / grid.get_width();
-                //if number of bits has not yet been reached then
-                if (idx<num_bits) {
-                    //if x,y in grid is alive then set bit by using a bitwise OR with 1 (true)
-                    if (grid.get(x,y)==Cell::ALIVE) {
-                        byte |= 1U << i;
-                    //else clear bit by using a bitwise AND on itself and NOT itself
-                    } else {
-                        byte &= ~(1U << i);
-                    }
+        //rows in the file are not padded to a word boundary, so row words are appended to a 64 bit
+        //buffer which is written out every time it fills up
+        std::uint64_t buffer = 0;
+        unsigned int buffered_bits = 0;
+        for (unsigned int y=0; y<height; y++) {
+            for (unsigned int i=0; i<view.get_words_per_row(); i++) {
+                const std::uint64_t word = view.get_word(y, i);
+                //number of cells of the grid held in this word, the bits past the width are 0
+                const unsigned int bits = (width-i*Grid::BITS_PER_WORD < Grid::BITS_PER_WORD)
+                    ? width-i*Grid::BITS_PER_WORD : Grid::BITS_PER_WORD;
+                buffer |= word << buffered_bits;
+                if (buffered_bits+bits >= Grid::BITS_PER_WORD) {
+                    //buffer is full, write it and keep the bits of the word that did not fit
+                    write_word(out, buffer, 8);
+                    const unsigned int used_bits = Grid::BITS_PER_WORD-buffered_bits;
+                    buffer = (used_bits==Grid::BITS_PER_WORD) ? 0 : (word >> used_bits);
+                    buffered_bits = buffered_bits+bits-Grid::BITS_PER_WORD;
+                } else {
+                    buffered_bits += bits;
                 }
-                //increment number of bits reached
-                idx++;
             }
-            //outputs 8 cell values within the grid to file (8 bit = 1 byte)
-            out.write(&byte, 1);
         }
+        //outputs the remaining bits padded with 0 bits up to a whole byte
+        write_word(out, buffer, (buffered_bits+7)/8);
         //closes ofstream to prevent memory leaks
         out.close();
     //else throw exception
     } else {
         throw std::invalid_argument("Zoo::save_binary file does not exist.");
     }
-}
\ No newline at end of file
+}
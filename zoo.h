@@ -13,6 +13,9 @@
 // Add the minimal number of includes you need in order to declare the namespace.
 // #include ...
 #include "grid.h"
+
+class GridView;
+
 /**
  * Declare the interface of the Zoo namespace for constructing lifeforms and saving and loading them from file.
  */
@@ -21,7 +24,9 @@ namespace Zoo {
     Grid r_pentomino();
     Grid light_weight_spaceship();
     Grid load_ascii(const std::string path);
-    void save_ascii(const std::string path, const Grid grid);
+    void save_ascii(const std::string path, const Grid &grid);
+    void save_ascii(const std::string path, const GridView &view);
     Grid load_binary(const std::string path);
-    void save_binary(const std::string path, const Grid grid);
+    void save_binary(const std::string path, const Grid &grid);
+    void save_binary(const std::string path, const GridView &view);
 };
\ No newline at end of file